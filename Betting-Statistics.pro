@@ -1,25 +1,67 @@
-#-------------------------------------------------
-#
-# Project created by QtCreator 2016-05-02T15:42:57
-#
-#-------------------------------------------------
-
-QT       += core gui
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
-
-TARGET = bettingstatistics
-TEMPLATE = app
-
-
-SOURCES += main.cpp\
-        mainwindow.cpp \
-    qcustomplot.cpp
-
-HEADERS  += mainwindow.h \
-    qcustomplot/qcustomplot.h \
-    qcustomplot.h
-
-FORMS    += mainwindow.ui
-
-RC_ICONS = icon.ico
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-05-02T15:42:57
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport concurrent
+
+TARGET = bettingstatistics
+TEMPLATE = app
+
+
+SOURCES += main.cpp\
+        mainwindow.cpp \
+    qcustomplot.cpp \
+    rangeaggregates.cpp \
+    riskanalytics.cpp \
+    runningmoments.cpp \
+    quantilesketch.cpp \
+    teamindex.cpp \
+    betstore.cpp \
+    betaggregates.cpp \
+    exactsum.cpp \
+    moneyformat.cpp \
+    teamsymbols.cpp \
+    prefixtrie.cpp \
+    teammatcher.cpp \
+    betindex.cpp \
+    betfiltermodel.cpp \
+    rollupcube.cpp \
+    pivotdialog.cpp \
+    expression.cpp \
+    bankrollsimulation.cpp \
+    ledgerfile.cpp \
+    ledgermodel.cpp \
+    archivedialog.cpp
+
+HEADERS  += mainwindow.h \
+    qcustomplot/qcustomplot.h \
+    qcustomplot.h \
+    rangeaggregates.h \
+    riskanalytics.h \
+    runningmoments.h \
+    quantilesketch.h \
+    teamindex.h \
+    betstore.h \
+    betaggregates.h \
+    exactsum.h \
+    moneyformat.h \
+    teamsymbols.h \
+    prefixtrie.h \
+    teammatcher.h \
+    betindex.h \
+    betfiltermodel.h \
+    rollupcube.h \
+    pivotdialog.h \
+    expression.h \
+    bankrollsimulation.h \
+    ledgerfile.h \
+    ledgermodel.h \
+    archivedialog.h
+
+FORMS    += mainwindow.ui
+
+RC_ICONS = icon.ico
@@ -0,0 +1,168 @@
+#include "archivedialog.h"
+#include "teamsymbols.h"
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QFileInfo>
+
+namespace {
+
+//Long enough to get through a few blocks, short enough to keep scrolling smooth
+const int ScanSliceMilliseconds = 20;
+
+//Indexing progress is shown in per mille of the file, the range switches to blocks for the scan
+const int IndexProgressRange = 1000;
+
+}
+
+ArchiveDialog::ArchiveDialog(const QString& path, qint64 cacheLimit, const MoneyFormat& format, QWidget* parent) :
+    QDialog(parent),
+    m_model(new LedgerModel(&m_ledger, this)),
+    m_format(format),
+    m_view(new QTableView(this)),
+    m_progress(new QProgressBar(this)),
+    m_statistics(new QLabel(this)),
+    m_nextBlock(-1),
+    m_skipped(0)
+{
+    setWindowTitle("Archive - " + QFileInfo(path).fileName());
+
+    m_ledger.setCacheLimit(cacheLimit);
+    if(!m_ledger.open(path, &m_error))
+        return;
+
+    m_view->setModel(m_model);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    m_statistics->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_progress->setRange(0, IndexProgressRange);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(m_view);
+    layout->addWidget(m_statistics);
+    layout->addWidget(m_progress);
+
+    resize(640, 560);
+
+    updateStatistics();
+    QTimer::singleShot(0, this, SLOT(scan()));
+}
+
+void ArchiveDialog::scan()
+{
+    LedgerFile::Block block;
+    QElapsedTimer timer;
+    timer.start();
+
+    //Block offsets are found first; the oldest block is only known once the whole file is indexed
+    if(!m_ledger.isIndexed()) {
+        bool indexed = false;
+        while(!indexed && timer.elapsed() < ScanSliceMilliseconds)
+            indexed = m_ledger.indexMore();
+
+        m_model->refresh();
+
+        if(indexed) {
+            //The file is stored newest first, so the oldest block is the last one
+            m_nextBlock = m_ledger.blockCount() - 1;
+            m_progress->setRange(0, m_ledger.blockCount());
+        }
+    }
+
+    while(m_nextBlock >= 0 && timer.elapsed() < ScanSliceMilliseconds) {
+        //Streamed blocks bypass the cache so they do not evict the rows being looked at
+        if(m_ledger.read(m_nextBlock, block)) {
+            for(int row = block.rows - 1; row >= 0; row--) {
+                const QString* cells = block.cells.constData() + row * LedgerFile::Columns;
+
+                bool ok;
+                double amount = m_format.parse(cells[3], &ok);
+                if(!ok || cells[1].isEmpty() || cells[2].isEmpty()) {
+                    m_skipped++;
+                    continue;
+                }
+
+                int winners = teamId(cells[1]);
+                int losers = teamId(cells[2]);
+
+                m_aggregates.add(winners, losers, amount);
+                m_summary = RiskAnalytics::Summary::combine(m_summary, RiskAnalytics::Summary::leaf(amount));
+            }
+        }
+
+        m_nextBlock--;
+    }
+
+    updateStatistics();
+
+    if(!m_ledger.isIndexed() || m_nextBlock >= 0)
+        QTimer::singleShot(0, this, SLOT(scan()));
+    else
+        m_progress->hide();
+}
+
+int ArchiveDialog::teamId(const QString& name)
+{
+    //Archive names are numbered locally so they never grow the process-wide table; names
+    //the table already knows are keyed by their canonical team so aliases still merge
+    TeamSymbols& symbols = TeamSymbols::instance();
+    int known = symbols.find(name);
+    QString display = known >= 0 ? symbols.name(symbols.canonical(known)) : name.simplified();
+    QString key = TeamSymbols::fold(display);
+
+    QHash<QString, int>::const_iterator it = m_teamIds.constFind(key);
+    if(it != m_teamIds.constEnd())
+        return it.value();
+
+    int id = m_teamNames.size();
+    m_teamIds.insert(key, id);
+    m_teamNames.append(display);
+    return id;
+}
+
+void ArchiveDialog::updateStatistics()
+{
+    bool indexed = m_ledger.isIndexed();
+    if(indexed)
+        m_progress->setValue(m_ledger.blockCount() - 1 - m_nextBlock);
+    else
+        m_progress->setValue(int(IndexProgressRange * m_ledger.indexedBytes() / qMax(Q_INT64_C(1), m_ledger.size())));
+
+    QStringList lines;
+    lines << "Bets: " + QString::number(m_ledger.rowCount()) + (!indexed ? " (indexing...)" : m_nextBlock >= 0 ? " (scanning...)" : "");
+
+    if(m_summary.count > 0) {
+        lines << "Wins: " + QString::number(m_summary.wins) + " (" + QString::number(100.0 * m_summary.wins / m_summary.count, 'f', 1) + "%)" +
+                 "   Total: " + m_format.text(m_summary.sum) +
+                 "   Won: " + m_format.text(m_summary.wonSum) +
+                 "   Lost: " + m_format.text(m_summary.lostSum);
+        lines << "Max drawdown: " + m_format.text(m_summary.maxDrawdown) +
+                 "   Streaks: " + QString::number(m_summary.winStreak) + " won / " + QString::number(m_summary.lossStreak) + " lost" +
+                 "   Expectancy: " + m_format.text(m_aggregates.moments.mean());
+        lines << "Median / 90% / 99%: " + m_format.text(m_aggregates.sketch.quantile(0.5)) + " / " +
+                 m_format.text(m_aggregates.sketch.quantile(0.9)) + " / " +
+                 m_format.text(m_aggregates.sketch.quantile(0.99));
+
+        //Same rule as TeamIndex::mostMoney, but ties are broken on the archive's own names
+        const TeamIndex::Team* mostMoney = nullptr;
+        foreach(int id, m_aggregates.teams.ids()) {
+            const TeamIndex::Team* team = m_aggregates.teams.team(id);
+            if(team->wins == 0)
+                continue;
+
+            if(mostMoney == nullptr || team->money > mostMoney->money ||
+               (team->money == mostMoney->money && m_teamNames.at(id).compare(m_teamNames.at(mostMoney->id), Qt::CaseInsensitive) < 0))
+                mostMoney = team;
+        }
+        if(mostMoney != nullptr)
+            lines << "Best team (money): " + m_teamNames.at(mostMoney->id) + " (" + m_format.text(mostMoney->money) + ")";
+    }
+
+    if(m_skipped > 0)
+        lines << "Unreadable rows skipped: " + QString::number(m_skipped);
+
+    m_statistics->setText(lines.join("\n"));
+}
@@ -0,0 +1,57 @@
+#ifndef ARCHIVEDIALOG_H
+#define ARCHIVEDIALOG_H
+
+#include <QDialog>
+#include <QHash>
+#include <QVector>
+#include <QLabel>
+#include <QProgressBar>
+#include <QTableView>
+#include "ledgerfile.h"
+#include "ledgermodel.h"
+#include "riskanalytics.h"
+#include "betaggregates.h"
+#include "moneyformat.h"
+
+//Browses a ledger too large to load into the bet table. Rows are paged in
+//through the ledger's block cache while scrolling. The file is indexed and then
+//the statistics are streamed over the blocks oldest first, both in short slices
+//on the event loop, so the dialog opens at once and only one block and the
+//fixed-size summaries are held at any time.
+class ArchiveDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ArchiveDialog(const QString& path, qint64 cacheLimit, const MoneyFormat& format, QWidget* parent = 0);
+
+    bool isOpen() const { return m_ledger.isOpen(); }
+    QString errorString() const { return m_error; }
+
+private slots:
+    void scan();
+
+private:
+    LedgerFile m_ledger;
+    LedgerModel* m_model;
+    MoneyFormat m_format;
+    QString m_error;
+
+    QTableView* m_view;
+    QProgressBar* m_progress;
+    QLabel* m_statistics;
+
+    int m_nextBlock;
+    qint64 m_skipped;
+    RiskAnalytics::Summary m_summary;
+    BetAggregates m_aggregates;
+
+    //Team ids of this archive only, released with the dialog
+    QHash<QString, int> m_teamIds;
+    QVector<QString> m_teamNames;
+
+    int teamId(const QString& name);
+    void updateStatistics();
+};
+
+#endif // ARCHIVEDIALOG_H
@@ -0,0 +1,202 @@
+#include "bankrollsimulation.h"
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+
+namespace {
+
+//Bands are drawn at plot resolution, longer histories are sampled at this many steps
+const int MaxSteps = 512;
+//Small enough to show up within a frame or two, later rounds double in size
+const int FirstRound = 256;
+
+quint64 splitMix(quint64 x)
+{
+    x += Q_UINT64_C(0x9E3779B97F4A7C15);
+    x = (x ^ (x >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+    x = (x ^ (x >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+    return x ^ (x >> 31);
+}
+
+struct PathSimulator
+{
+    typedef QVector<float> result_type;
+
+    explicit PathSimulator(const QSharedPointer<BankrollSimulation::Run>& run) : m_run(run) {}
+
+    //Values are laid out step-major: result[step * count + path]
+    QVector<float> operator()(const BankrollSimulation::Chunk& chunk) const
+    {
+        const QVector<double>& amounts = m_run->amounts;
+        const QVector<int>& steps = m_run->steps;
+        const quint32 size = amounts.size();
+
+        QVector<float> result(steps.size() * chunk.count);
+
+        for(int p = 0; p < chunk.count; p++) {
+            if(m_run->cancelled.load())
+                return QVector<float>();
+
+            //Seeded per path rather than per thread, so results do not depend on how paths were split up
+            quint64 state = splitMix(m_run->seed ^ quint64(chunk.first + p)) | 1;
+            double total = 0;
+            int t = 0;
+
+            for(int k = 0; k < steps.size(); k++) {
+                for(; t < steps.at(k); t++) {
+                    //xorshift64*, the high 32 bits mapped onto [0, size) by multiply-shift
+                    state ^= state >> 12;
+                    state ^= state << 25;
+                    state ^= state >> 27;
+                    quint32 random = quint32((state * Q_UINT64_C(0x2545F4914F6CDD1D)) >> 32);
+                    total += amounts.at(int((quint64(random) * size) >> 32));
+                }
+                result[k * chunk.count + p] = float(total);
+            }
+        }
+
+        return result;
+    }
+
+    QSharedPointer<BankrollSimulation::Run> m_run;
+};
+
+}
+
+BankrollSimulation::BankrollSimulation(QObject* parent) :
+    QObject(parent),
+    m_done(0),
+    m_target(0),
+    m_seed(Q_UINT64_C(0x853C49E6748FEA9B))
+{
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(roundFinished()));
+}
+
+BankrollSimulation::~BankrollSimulation()
+{
+    cancel();
+}
+
+void BankrollSimulation::start(const QVector<double>& amounts, int paths)
+{
+    cancel();
+
+    m_bands = Bands();
+    m_samples.clear();
+    m_done = 0;
+    m_target = paths;
+
+    if(amounts.isEmpty() || paths <= 0) {
+        emit bandsChanged();
+        return;
+    }
+
+    m_run = QSharedPointer<Run>(new Run);
+    m_run->amounts = amounts;
+    m_run->seed = m_seed;
+    m_run->cancelled.store(0);
+
+    //Every step when the history is short, evenly spread steps otherwise
+    int size = amounts.size();
+    int count = qMin(size + 1, MaxSteps);
+    for(int k = 0; k < count; k++)
+        m_run->steps.append(count == size + 1 ? k : int(qint64(k) * size / (count - 1)));
+
+    m_samples.resize(count);
+    for(int k = 0; k < count; k++)
+        m_bands.keys.append(m_run->steps.at(k));
+
+    startRound();
+}
+
+void BankrollSimulation::cancel()
+{
+    if(m_run.isNull())
+        return;
+
+    //Workers check the flag between paths, so waiting here is short
+    m_run->cancelled.store(1);
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+    m_run.clear();
+}
+
+bool BankrollSimulation::isRunning() const
+{
+    return !m_run.isNull();
+}
+
+void BankrollSimulation::roundFinished()
+{
+    if(m_run.isNull() || m_run->cancelled.load() || m_watcher.isCanceled())
+        return;
+
+    QFuture<QVector<float> > future = m_watcher.future();
+    int steps = m_samples.size();
+
+    for(int i = 0; i < m_chunks.size(); i++) {
+        const QVector<float> result = future.resultAt(i);
+        int count = m_chunks.at(i).count;
+
+        for(int k = 0; k < steps; k++)
+            m_samples[k] += result.mid(k * count, count);
+
+        m_done += count;
+    }
+
+    updateBands();
+
+    if(m_done < m_target)
+        startRound();
+    else
+        m_run.clear();
+
+    emit bandsChanged();
+}
+
+void BankrollSimulation::startRound()
+{
+    int round = qMin(m_target - m_done, qMax(FirstRound, m_done));
+
+    //A few chunks per thread so uneven scheduling still balances out
+    int threads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    int chunkSize = qMax(1, round / (threads * 4));
+
+    m_chunks.clear();
+    for(int first = 0; first < round; first += chunkSize) {
+        Chunk chunk;
+        chunk.first = m_done + first;
+        chunk.count = qMin(chunkSize, round - first);
+        m_chunks.append(chunk);
+    }
+
+    m_watcher.setFuture(QtConcurrent::mapped(m_chunks, PathSimulator(m_run)));
+}
+
+void BankrollSimulation::updateBands()
+{
+    int steps = m_samples.size();
+
+    m_bands.low.resize(steps);
+    m_bands.median.resize(steps);
+    m_bands.high.resize(steps);
+
+    QVector<float> column;
+    for(int k = 0; k < steps; k++) {
+        column = m_samples.at(k);
+        int size = column.size();
+
+        //Each selection only searches the part from the previous one upwards
+        int low = int(0.05 * (size - 1));
+        int median = int(0.5 * (size - 1));
+        int high = int(0.95 * (size - 1));
+
+        //Selections move the element they start from, so each value is read right away
+        std::nth_element(column.begin(), column.begin() + low, column.end());
+        m_bands.low[k] = column.at(low);
+        std::nth_element(column.begin() + low, column.begin() + median, column.end());
+        m_bands.median[k] = column.at(median);
+        std::nth_element(column.begin() + median, column.begin() + high, column.end());
+        m_bands.high[k] = column.at(high);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef BANKROLLSIMULATION_H
+#define BANKROLLSIMULATION_H
+
+#include <QObject>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QAtomicInt>
+
+//Bootstrap Monte-Carlo of the bankroll curve: every simulated path draws its bets
+//with replacement from the real amounts. Paths are simulated in rounds of growing
+//size on the global thread pool, and the 5/50/95% bands are republished after
+//every round so a rough picture is available long before all paths are done.
+class BankrollSimulation : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int DefaultPaths = 5000;
+
+    struct Bands
+    {
+        //Bet numbers the bands are sampled at, 0 is the starting bankroll
+        QVector<double> keys;
+        QVector<double> low;
+        QVector<double> median;
+        QVector<double> high;
+    };
+
+    //Shared with the worker threads, which outlive a cancelled run only until cancel() returns
+    struct Run
+    {
+        QVector<double> amounts;
+        QVector<int> steps;
+        quint64 seed;
+        QAtomicInt cancelled;
+    };
+
+    struct Chunk
+    {
+        int first;
+        int count;
+    };
+
+    explicit BankrollSimulation(QObject* parent = 0);
+    ~BankrollSimulation();
+
+    //Restarts the simulation, a run in progress is cancelled
+    void start(const QVector<double>& amounts, int paths = DefaultPaths);
+    void cancel();
+
+    bool isRunning() const;
+    int paths() const { return m_done; }
+    const Bands& bands() const { return m_bands; }
+
+signals:
+    void bandsChanged();
+
+private slots:
+    void roundFinished();
+
+private:
+    QSharedPointer<Run> m_run;
+    QFutureWatcher<QVector<float> > m_watcher;
+    QVector<Chunk> m_chunks;
+    int m_done;
+    int m_target;
+    quint64 m_seed;
+
+    //One column of simulated bankrolls per sampled step
+    QVector<QVector<float> > m_samples;
+    Bands m_bands;
+
+    void startRound();
+    void updateBands();
+};
+
+#endif // BANKROLLSIMULATION_H
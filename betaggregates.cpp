@@ -0,0 +1,104 @@
+#include "betaggregates.h"
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace {
+
+//Chunks smaller than this cost more in scheduling than they save
+const int MinimumChunkSize = 16384;
+
+struct ChunkReducer
+{
+    typedef BetAggregates result_type;
+
+    explicit ChunkReducer(const BetStore& store) : m_store(store) {}
+
+    BetAggregates operator()(const QPair<int, int>& chunk) const
+    {
+        return BetAggregates::compute(m_store, chunk.first, chunk.second);
+    }
+
+    const BetStore& m_store;
+};
+
+void mergeChunk(BetAggregates& result, const BetAggregates& partial)
+{
+    result.merge(partial);
+}
+
+}
+
+void BetAggregates::clear()
+{
+    total = ExactSum();
+    moments.clear();
+    sketch.clear();
+    teams.clear();
+}
+
+void BetAggregates::add(int winners, int losers, double amount)
+{
+    total.add(amount);
+    moments.add(amount);
+    sketch.add(amount);
+    teams.add(winners, losers, amount);
+}
+
+void BetAggregates::remove(int winners, int losers, double amount)
+{
+    total -= ExactSum(amount);
+    moments.remove(amount);
+    teams.remove(winners, losers, amount);
+}
+
+void BetAggregates::merge(const BetAggregates& other)
+{
+    total += other.total;
+    moments.merge(other.moments);
+    sketch.merge(other.sketch);
+    teams.merge(other.teams);
+}
+
+BetAggregates BetAggregates::compute(const BetStore& store)
+{
+    //A few chunks per thread so uneven chunks still balance out
+    int threads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    int chunkSize = qMax(MinimumChunkSize, store.size() / (threads * 4) + 1);
+
+    if(store.size() <= chunkSize)
+        return compute(store, 0, store.size() - 1);
+
+    QVector<QPair<int, int> > chunks;
+    for(int first = 0; first < store.size(); first += chunkSize)
+        chunks.append(qMakePair(first, qMin(first + chunkSize, store.size()) - 1));
+
+    return QtConcurrent::blockingMappedReduced<BetAggregates>(chunks, ChunkReducer(store), mergeChunk,
+                                                              QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce);
+}
+
+BetAggregates BetAggregates::compute(const BetStore& store, int first, int last)
+{
+    BetAggregates aggregates;
+
+    const QVector<int>& winners = store.winners();
+    const QVector<int>& losers = store.losers();
+
+    if(last < first)
+        return aggregates;
+
+    //The column total goes through the block kernel, the rest needs the per-bet path
+    if(store.isFixed())
+        aggregates.total.add(store.units().constData() + first, last - first + 1);
+    else
+        aggregates.total.add(store.amounts().constData() + first, last - first + 1);
+
+    for(int i = first; i <= last; i++) {
+        double amount = store.amount(i);
+        aggregates.moments.add(amount);
+        aggregates.sketch.add(amount);
+        aggregates.teams.add(winners.at(i), losers.at(i), amount);
+    }
+
+    return aggregates;
+}
@@ -0,0 +1,29 @@
+#ifndef BETAGGREGATES_H
+#define BETAGGREGATES_H
+
+#include "betstore.h"
+#include "runningmoments.h"
+#include "quantilesketch.h"
+#include "teamindex.h"
+
+//Aggregates that can be computed for any slice of the bets and merged
+//afterwards, which lets full recomputes run as a map-reduce over row chunks.
+struct BetAggregates
+{
+    ExactSum total;
+    RunningMoments moments;
+    QuantileSketch sketch;
+    TeamIndex teams;
+
+    void clear();
+    void add(int winners, int losers, double amount);
+    void remove(int winners, int losers, double amount);
+    void merge(const BetAggregates& other);
+
+    //Splits the store into chunks, reduces them on the global thread pool and
+    //merges the partial results in chunk order
+    static BetAggregates compute(const BetStore& store);
+    static BetAggregates compute(const BetStore& store, int first, int last);
+};
+
+#endif // BETAGGREGATES_H
@@ -0,0 +1,263 @@
+#include "betfiltermodel.h"
+#include <QtMath>
+#include <algorithm>
+
+BetFilterModel::BetFilterModel(QObject* parent) :
+    QAbstractProxyModel(parent),
+    m_filtered(false),
+    m_idRole(Qt::UserRole)
+{
+}
+
+void BetFilterModel::setSourceModel(QAbstractItemModel* model)
+{
+    beginResetModel();
+
+    if(sourceModel() != nullptr)
+        disconnect(sourceModel(), nullptr, this, nullptr);
+
+    QAbstractProxyModel::setSourceModel(model);
+    m_filtered = false;
+    m_rows.clear();
+
+    if(model != nullptr) {
+        connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)), this, SLOT(sourceDataChanged(QModelIndex,QModelIndex,QVector<int>)));
+        connect(model, SIGNAL(headerDataChanged(Qt::Orientation,int,int)), this, SLOT(sourceHeaderDataChanged(Qt::Orientation,int,int)));
+
+        //Row inserts and removals reset the view, the owner refilters afterwards
+        connect(model, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)), this, SLOT(sourceAboutToChange()));
+        connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)), this, SLOT(sourceChanged()));
+        connect(model, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)), this, SLOT(sourceAboutToChange()));
+        connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, SLOT(sourceChanged()));
+        connect(model, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)), this, SLOT(sourceAboutToChange()));
+        connect(model, SIGNAL(columnsInserted(QModelIndex,int,int)), this, SLOT(sourceChanged()));
+        connect(model, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)), this, SLOT(sourceAboutToChange()));
+        connect(model, SIGNAL(columnsRemoved(QModelIndex,int,int)), this, SLOT(sourceChanged()));
+        connect(model, SIGNAL(modelAboutToBeReset()), this, SLOT(sourceAboutToChange()));
+        connect(model, SIGNAL(modelReset()), this, SLOT(sourceChanged()));
+        connect(model, SIGNAL(layoutAboutToBeChanged()), this, SLOT(sourceLayoutAboutToBeChanged()));
+        connect(model, SIGNAL(layoutChanged()), this, SLOT(sourceLayoutChanged()));
+    }
+
+    endResetModel();
+}
+
+void BetFilterModel::setRows(const QVector<int>& rows)
+{
+    beginResetModel();
+    m_filtered = true;
+    m_rows = rows;
+    endResetModel();
+}
+
+void BetFilterModel::clearFilter()
+{
+    if(!m_filtered)
+        return;
+
+    beginResetModel();
+    m_filtered = false;
+    m_rows.clear();
+    endResetModel();
+}
+
+int BetFilterModel::sourceRow(int row) const
+{
+    return m_filtered ? m_rows.at(row) : row;
+}
+
+void BetFilterModel::setExtraColumns(const QStringList& headers, int idRole)
+{
+    beginResetModel();
+    m_extraHeaders = headers;
+    m_extraValues.clear();
+    m_extraAmounts.clear();
+    m_idRole = idRole;
+    endResetModel();
+}
+
+void BetFilterModel::setExtraValues(const QVector<QVector<double> >& values, const QVector<bool>& amounts, const MoneyFormat& format)
+{
+    m_extraValues = values;
+    m_extraAmounts = amounts;
+    m_moneyFormat = format;
+
+    if(rowCount() > 0 && !m_extraHeaders.isEmpty())
+        emit dataChanged(index(0, sourceColumns()), index(rowCount() - 1, columnCount() - 1));
+}
+
+QModelIndex BetFilterModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if(parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+        return QModelIndex();
+
+    return createIndex(row, column);
+}
+
+QModelIndex BetFilterModel::parent(const QModelIndex&) const
+{
+    return QModelIndex();
+}
+
+int BetFilterModel::rowCount(const QModelIndex& parent) const
+{
+    if(parent.isValid() || sourceModel() == nullptr)
+        return 0;
+
+    return m_filtered ? m_rows.size() : sourceModel()->rowCount();
+}
+
+int BetFilterModel::columnCount(const QModelIndex& parent) const
+{
+    if(parent.isValid() || sourceModel() == nullptr)
+        return 0;
+
+    return sourceModel()->columnCount() + m_extraHeaders.size();
+}
+
+int BetFilterModel::sourceColumns() const
+{
+    return sourceModel() == nullptr ? 0 : sourceModel()->columnCount();
+}
+
+QVariant BetFilterModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    //The base class maps sections through row 0, which an empty filter result does not have
+    if(orientation == Qt::Horizontal && section >= sourceColumns() && section < columnCount())
+        return role == Qt::DisplayRole ? QVariant(m_extraHeaders.at(section - sourceColumns())) : QVariant();
+
+    if(orientation == Qt::Horizontal && sourceModel() != nullptr)
+        return sourceModel()->headerData(section, orientation, role);
+
+    return QAbstractProxyModel::headerData(section, orientation, role);
+}
+
+QVariant BetFilterModel::data(const QModelIndex& proxyIndex, int role) const
+{
+    if(!proxyIndex.isValid() || proxyIndex.column() < sourceColumns())
+        return QAbstractProxyModel::data(proxyIndex, role);
+
+    if(role == Qt::TextAlignmentRole)
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    if(role != Qt::DisplayRole)
+        return QVariant();
+
+    //Computed values are stored by bet id, which survives sorting and filtering
+    int column = proxyIndex.column() - sourceColumns();
+    int id = sourceModel()->index(sourceRow(proxyIndex.row()), 0).data(m_idRole).toInt();
+
+    if(column >= m_extraValues.size() || id < 0 || id >= m_extraValues.at(column).size() || qIsNaN(m_extraValues.at(column).at(id)))
+        return QVariant();
+
+    double value = m_extraValues.at(column).at(id);
+    return m_extraAmounts.value(column) ? m_moneyFormat.moneyText(value) : QString::number(value);
+}
+
+Qt::ItemFlags BetFilterModel::flags(const QModelIndex& index) const
+{
+    if(index.isValid() && index.column() >= sourceColumns())
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+
+    return QAbstractProxyModel::flags(index);
+}
+
+void BetFilterModel::sort(int column, Qt::SortOrder order)
+{
+    //Computed columns have no source column to sort by
+    if(column < sourceColumns())
+        QAbstractProxyModel::sort(column, order);
+}
+
+QModelIndex BetFilterModel::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if(!proxyIndex.isValid() || sourceModel() == nullptr || proxyIndex.column() >= sourceColumns())
+        return QModelIndex();
+
+    return sourceModel()->index(sourceRow(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex BetFilterModel::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if(!sourceIndex.isValid())
+        return QModelIndex();
+
+    if(!m_filtered)
+        return index(sourceIndex.row(), sourceIndex.column());
+
+    //Filtered rows are ascending, so the reverse lookup is a binary search
+    QVector<int>::const_iterator it = std::lower_bound(m_rows.constBegin(), m_rows.constEnd(), sourceIndex.row());
+    if(it == m_rows.constEnd() || *it != sourceIndex.row())
+        return QModelIndex();
+
+    return index(int(it - m_rows.constBegin()), sourceIndex.column());
+}
+
+void BetFilterModel::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    if(!m_filtered) {
+        emit dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
+        return;
+    }
+
+    //Only the visible part of the changed block matters
+    QVector<int>::const_iterator first = std::lower_bound(m_rows.constBegin(), m_rows.constEnd(), topLeft.row());
+    QVector<int>::const_iterator last = std::upper_bound(m_rows.constBegin(), m_rows.constEnd(), bottomRight.row());
+    if(first == last)
+        return;
+
+    emit dataChanged(index(int(first - m_rows.constBegin()), topLeft.column()),
+                     index(int(last - m_rows.constBegin()) - 1, bottomRight.column()), roles);
+}
+
+void BetFilterModel::sourceHeaderDataChanged(Qt::Orientation orientation, int first, int last)
+{
+    if(orientation == Qt::Horizontal)
+        emit headerDataChanged(orientation, first, last);
+}
+
+void BetFilterModel::sourceAboutToChange()
+{
+    beginResetModel();
+}
+
+void BetFilterModel::sourceChanged()
+{
+    //Stored source rows no longer mean anything, show nothing until refiltered
+    m_rows.clear();
+    endResetModel();
+}
+
+void BetFilterModel::sourceLayoutAboutToBeChanged()
+{
+    if(m_filtered) {
+        beginResetModel();
+        return;
+    }
+
+    //Unfiltered rows map one to one, so persistent indexes (selection, current item) can follow the sort
+    emit layoutAboutToBeChanged();
+
+    m_layoutProxy = persistentIndexList();
+    m_layoutSource.clear();
+    for(int i = 0; i < m_layoutProxy.size(); i++)
+        m_layoutSource.append(QPersistentModelIndex(mapToSource(m_layoutProxy.at(i))));
+}
+
+void BetFilterModel::sourceLayoutChanged()
+{
+    if(m_filtered) {
+        m_rows.clear();
+        endResetModel();
+        return;
+    }
+
+    QModelIndexList to;
+    for(int i = 0; i < m_layoutSource.size(); i++)
+        to.append(mapFromSource(m_layoutSource.at(i)));
+
+    changePersistentIndexList(m_layoutProxy, to);
+    m_layoutProxy.clear();
+    m_layoutSource.clear();
+
+    emit layoutChanged();
+}
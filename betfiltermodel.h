@@ -0,0 +1,68 @@
+#ifndef BETFILTERMODEL_H
+#define BETFILTERMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QVector>
+#include <QPersistentModelIndex>
+#include <QStringList>
+#include "moneyformat.h"
+
+//Shows either every row of the source model or a precomputed, ascending list
+//of source rows. Unlike QSortFilterProxyModel it never tests rows itself, the
+//row list comes from the bet indexes. Read-only computed columns can be
+//appended after the source columns; their values are looked up by bet id.
+class BetFilterModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit BetFilterModel(QObject* parent = 0);
+
+    void setSourceModel(QAbstractItemModel* sourceModel);
+
+    bool isFiltered() const { return m_filtered; }
+    void setRows(const QVector<int>& rows);
+    void clearFilter();
+
+    int sourceRow(int row) const;
+
+    QStringList extraColumns() const { return m_extraHeaders; }
+    void setExtraColumns(const QStringList& headers, int idRole);
+    //Columns flagged in amounts hold money and are shown through the format
+    void setExtraValues(const QVector<QVector<double> >& values, const QVector<bool>& amounts, const MoneyFormat& format);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex& child) const;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    QVariant data(const QModelIndex& proxyIndex, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex& index) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const;
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const;
+
+private slots:
+    void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+    void sourceHeaderDataChanged(Qt::Orientation orientation, int first, int last);
+    void sourceAboutToChange();
+    void sourceChanged();
+    void sourceLayoutAboutToBeChanged();
+    void sourceLayoutChanged();
+
+private:
+    bool m_filtered;
+    QVector<int> m_rows;
+    QModelIndexList m_layoutProxy;
+    QList<QPersistentModelIndex> m_layoutSource;
+    QStringList m_extraHeaders;
+    QVector<QVector<double> > m_extraValues;
+    QVector<bool> m_extraAmounts;
+    MoneyFormat m_moneyFormat;
+    int m_idRole;
+
+    int sourceColumns() const;
+};
+
+#endif // BETFILTERMODEL_H
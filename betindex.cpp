@@ -0,0 +1,65 @@
+#include "betindex.h"
+#include <algorithm>
+#include <iterator>
+
+void BetIndex::clear()
+{
+    m_postings.clear();
+}
+
+void BetIndex::build(const BetStore& store)
+{
+    clear();
+
+    for(int i = 0; i < store.size(); i++) {
+        m_postings[store.winners().at(i)].append(store.ids().at(i));
+        if(store.losers().at(i) != store.winners().at(i))
+            m_postings[store.losers().at(i)].append(store.ids().at(i));
+    }
+
+    //The store follows the table order, not the id order
+    for(QHash<int, QVector<int> >::iterator it = m_postings.begin(); it != m_postings.end(); ++it)
+        std::sort(it->begin(), it->end());
+}
+
+void BetIndex::add(int id, int winners, int losers)
+{
+    insert(m_postings[winners], id);
+    if(losers != winners)
+        insert(m_postings[losers], id);
+}
+
+void BetIndex::remove(int id, int winners, int losers)
+{
+    erase(m_postings[winners], id);
+    if(losers != winners)
+        erase(m_postings[losers], id);
+}
+
+QVector<int> BetIndex::bets(int team) const
+{
+    return m_postings.value(team);
+}
+
+QVector<int> BetIndex::intersect(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> result;
+    std::set_intersection(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+
+void BetIndex::insert(QVector<int>& posting, int id)
+{
+    //New bets get the highest id so far, appending is the common case
+    if(posting.isEmpty() || posting.last() < id)
+        posting.append(id);
+    else
+        posting.insert(std::lower_bound(posting.begin(), posting.end(), id), id);
+}
+
+void BetIndex::erase(QVector<int>& posting, int id)
+{
+    QVector<int>::iterator it = std::lower_bound(posting.begin(), posting.end(), id);
+    if(it != posting.end() && *it == id)
+        posting.erase(it);
+}
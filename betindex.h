@@ -0,0 +1,31 @@
+#ifndef BETINDEX_H
+#define BETINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include "betstore.h"
+
+//Inverted index from canonical team id to the ids of the bets it took part
+//in. Posting lists are kept sorted by bet id so they can be intersected with
+//other id lists in linear time.
+class BetIndex
+{
+public:
+    void clear();
+    void build(const BetStore& store);
+
+    void add(int id, int winners, int losers);
+    void remove(int id, int winners, int losers);
+
+    QVector<int> bets(int team) const;
+
+    static QVector<int> intersect(const QVector<int>& a, const QVector<int>& b);
+
+private:
+    QHash<int, QVector<int> > m_postings;
+
+    static void insert(QVector<int>& posting, int id);
+    static void erase(QVector<int>& posting, int id);
+};
+
+#endif // BETINDEX_H
@@ -0,0 +1,83 @@
+#include "betstore.h"
+
+void BetStore::clear(bool fixed)
+{
+    m_fixed = fixed;
+    m_days.clear();
+    m_ids.clear();
+    m_winners.clear();
+    m_losers.clear();
+    m_amounts.clear();
+    m_units.clear();
+    m_indexes.clear();
+}
+
+void BetStore::reserve(int size)
+{
+    m_days.reserve(size);
+    m_ids.reserve(size);
+    m_winners.reserve(size);
+    m_losers.reserve(size);
+    if(m_fixed)
+        m_units.reserve(size);
+    else
+        m_amounts.reserve(size);
+}
+
+void BetStore::append(int day, int id, int winners, int losers, double amount)
+{
+    Q_ASSERT(!m_fixed);
+    m_amounts.append(amount);
+    appendKey(day, id, winners, losers);
+}
+
+void BetStore::appendUnits(int day, int id, int winners, int losers, qint64 units)
+{
+    Q_ASSERT(m_fixed);
+    m_units.append(units);
+    appendKey(day, id, winners, losers);
+}
+
+void BetStore::appendKey(int day, int id, int winners, int losers)
+{
+    m_days.append(day);
+    m_ids.append(id);
+    m_winners.append(winners);
+    m_losers.append(losers);
+
+    //Bet ids are dense, so the id to index map is a plain vector
+    if(id >= m_indexes.size())
+        m_indexes.resize(id + 1);
+    m_indexes[id] = m_ids.size();
+}
+
+bool BetStore::remove(int id)
+{
+    //Indexes are stored one-based, zero marks an id that is not in the store
+    int index = indexOf(id);
+    if(index < 0)
+        return false;
+
+    int last = m_ids.size() - 1;
+    m_days[index] = m_days.at(last);
+    m_ids[index] = m_ids.at(last);
+    m_winners[index] = m_winners.at(last);
+    m_losers[index] = m_losers.at(last);
+    if(m_fixed)
+        m_units[index] = m_units.at(last);
+    else
+        m_amounts[index] = m_amounts.at(last);
+    m_indexes[m_ids.at(index)] = index + 1;
+    m_indexes[id] = 0;
+
+    m_days.removeLast();
+    m_ids.removeLast();
+    m_winners.removeLast();
+    m_losers.removeLast();
+    if(m_fixed)
+        m_units.removeLast();
+    else
+        m_amounts.removeLast();
+
+    return true;
+}
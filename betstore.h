@@ -0,0 +1,51 @@
+#ifndef BETSTORE_H
+#define BETSTORE_H
+
+#include <QVector>
+
+//Column-wise copy of the bet table, teams as interned ids. Unlike the QStandardItemModel it can be
+//read from worker threads and scanned without going through item text.
+class BetStore
+{
+public:
+    BetStore() : m_fixed(false) {}
+
+    //In fixed-point mode amounts are kept as exact integer units instead of doubles
+    void clear(bool fixed = false);
+    void reserve(int size);
+    void append(int day, int id, int winners, int losers, double amount);
+    void appendUnits(int day, int id, int winners, int losers, qint64 units);
+
+    //Moves the last bet into the removed one's place, so the store is unordered after a removal
+    bool remove(int id);
+
+    //Store index of a bet id, -1 if it is not in the store
+    int indexOf(int id) const { return id >= 0 && id < m_indexes.size() ? m_indexes.at(id) - 1 : -1; }
+
+    int size() const { return m_ids.size(); }
+    bool isFixed() const { return m_fixed; }
+
+    //Amount of bet i in statistics units, whichever column holds it
+    double amount(int i) const { return m_fixed ? double(m_units.at(i)) : m_amounts.at(i); }
+
+    const QVector<int>& days() const { return m_days; }
+    const QVector<int>& ids() const { return m_ids; }
+    const QVector<int>& winners() const { return m_winners; }
+    const QVector<int>& losers() const { return m_losers; }
+    const QVector<double>& amounts() const { return m_amounts; }
+    const QVector<qint64>& units() const { return m_units; }
+
+private:
+    void appendKey(int day, int id, int winners, int losers);
+
+    QVector<int> m_days;
+    QVector<int> m_ids;
+    QVector<int> m_winners;
+    QVector<int> m_losers;
+    QVector<double> m_amounts;
+    QVector<qint64> m_units;
+    QVector<int> m_indexes;
+    bool m_fixed;
+};
+
+#endif // BETSTORE_H
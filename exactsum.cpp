@@ -0,0 +1,83 @@
+#include "exactsum.h"
+#include <cmath>
+
+namespace {
+
+const double FractionScale = 4611686018427387904.0; // 2^62
+const double Limit = 4611686018427387903.0;
+
+//Additions per block in the bulk kernel; keeps the split fraction sums far from overflow
+const int BlockSize = 1 << 20;
+
+}
+
+ExactSum::ExactSum(double value) :
+    m_integer(0),
+    m_fraction(0)
+{
+    qint64 integer, fraction;
+    split(value, integer, fraction);
+    normalize(integer, fraction);
+}
+
+void ExactSum::add(const double* values, int count)
+{
+    //Branch-free integer accumulation: the fraction is kept as two 31-bit halves
+    //so a whole block can be summed before any carry has to be propagated
+    for(int first = 0; first < count; first += BlockSize) {
+        int last = qMin(first + BlockSize, count);
+        qint64 integers = 0, high = 0, low = 0;
+
+        for(int i = first; i < last; i++) {
+            qint64 integer, fraction;
+            split(values[i], integer, fraction);
+
+            integers += integer;
+            high += fraction >> 31;
+            low += fraction & 0x7fffffff;
+        }
+
+        qint64 carry = high >> 31;
+        qint64 rest = ((high & 0x7fffffff) << 31) + low;
+
+        ExactSum block;
+        block.normalize(integers + carry, rest);
+        *this += block;
+    }
+}
+
+void ExactSum::add(const qint64* units, int count)
+{
+    //Fixed-point units have no fraction, so they go straight into the integer part
+    qint64 integers = 0;
+    for(int i = 0; i < count; i++)
+        integers += units[i];
+
+    m_integer += integers;
+}
+
+double ExactSum::toDouble() const
+{
+    return double(m_integer) + double(m_fraction) / FractionScale;
+}
+
+void ExactSum::split(double value, qint64& integer, qint64& fraction)
+{
+    if(std::isnan(value))
+        value = 0;
+    value = qBound(-Limit, value, Limit);
+
+    //Both steps are exact; only fraction bits below 2^-62 are truncated
+    double integerPart = std::trunc(value);
+    integer = qint64(integerPart);
+    fraction = qint64((value - integerPart) * FractionScale);
+}
+
+void ExactSum::normalize(qint64 integer, qint64 fraction)
+{
+    //Floor division by 2^62 moves the whole units over, leaving 0 <= fraction < 2^62
+    qint64 carry = fraction >> 62;
+
+    m_integer = integer + carry;
+    m_fraction = quint64(fraction - carry * qint64(One));
+}
@@ -0,0 +1,68 @@
+#ifndef EXACTSUM_H
+#define EXACTSUM_H
+
+#include <QtGlobal>
+
+//Order-independent money accumulator. Every amount is split into its integer
+//part and its fraction in units of 2^-62, both summed as integers. The state is
+//kept canonical (0 <= fraction < 2^62), so any grouping or order of additions,
+//serial, parallel or incremental, ends in bit-identical totals.
+//Amounts are exact down to 2^-62; integer parts must stay below 2^62.
+class ExactSum
+{
+public:
+    ExactSum() : m_integer(0), m_fraction(0) {}
+    explicit ExactSum(double value);
+
+    void add(double value) { *this += ExactSum(value); }
+    void add(const double* values, int count);
+    void add(const qint64* units, int count);
+
+    double toDouble() const;
+    qint64 integerPart() const { return m_integer; }
+
+    ExactSum& operator+=(const ExactSum& other)
+    {
+        m_integer += other.m_integer;
+        m_fraction += other.m_fraction;
+        if(m_fraction >= One) {
+            m_fraction -= One;
+            m_integer++;
+        }
+        return *this;
+    }
+
+    ExactSum operator-() const
+    {
+        ExactSum negated;
+        negated.m_integer = m_fraction == 0 ? -m_integer : -m_integer - 1;
+        negated.m_fraction = m_fraction == 0 ? 0 : One - m_fraction;
+        return negated;
+    }
+
+    ExactSum& operator-=(const ExactSum& other) { return *this += -other; }
+
+    ExactSum operator+(const ExactSum& other) const { ExactSum sum(*this); return sum += other; }
+    ExactSum operator-(const ExactSum& other) const { ExactSum sum(*this); return sum -= other; }
+
+    bool operator==(const ExactSum& other) const { return m_integer == other.m_integer && m_fraction == other.m_fraction; }
+    bool operator!=(const ExactSum& other) const { return !(*this == other); }
+    bool operator<(const ExactSum& other) const
+    {
+        return m_integer < other.m_integer || (m_integer == other.m_integer && m_fraction < other.m_fraction);
+    }
+    bool operator>(const ExactSum& other) const { return other < *this; }
+    bool operator<=(const ExactSum& other) const { return !(other < *this); }
+    bool operator>=(const ExactSum& other) const { return !(*this < other); }
+
+private:
+    static const quint64 One = Q_UINT64_C(1) << 62;
+
+    qint64 m_integer;
+    quint64 m_fraction;
+
+    static void split(double value, qint64& integer, qint64& fraction);
+    void normalize(qint64 integer, qint64 fraction);
+};
+
+#endif // EXACTSUM_H
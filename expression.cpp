@@ -0,0 +1,726 @@
+#include "expression.h"
+#include "teamsymbols.h"
+#include <QDate>
+#include <QtMath>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+//Rows per batch: enough to amortize the dispatch, few enough for the stack to stay in cache
+static const int BatchSize = 1024;
+
+class ExpressionParser
+{
+public:
+    explicit ExpressionParser(const QString& text);
+
+    bool parse(Expression& expression);
+    QString error() const { return m_error; }
+
+private:
+    //Money is a number in currency, kept apart so results derived from amounts can be formatted as money
+    enum Type { Number, Money, Team, Text };
+    enum TokenKind { End, NumberToken, StringToken, Identifier, Symbol };
+
+    struct Operand
+    {
+        Type type;
+        int start;
+        QString text;
+    };
+
+    QString m_text;
+    int m_position;
+    TokenKind m_kind;
+    QString m_token;
+    double m_number;
+    int m_tokenPosition;
+    QString m_error;
+
+    Expression::Program* m_program;
+    int m_depth;
+    QVector<Expression::Aggregate>* m_aggregates;
+    bool m_insideAggregate;
+    bool m_columnOutside;
+
+    void next();
+    bool accept(const QString& symbol);
+    bool expect(const QString& symbol);
+    bool fail(const QString& message);
+
+    bool parseOr(Operand& result);
+    bool parseAnd(Operand& result);
+    bool parseComparison(Operand& result);
+    bool parseSum(Operand& result);
+    bool parseProduct(Operand& result);
+    bool parseUnary(Operand& result);
+    bool parsePrimary(Operand& result);
+    bool parseAggregate(Expression::AggregateKind kind, Operand& result);
+    bool parseInto(Expression::Program& program, const QString& name, Type* type = nullptr);
+
+    void emitInstruction(Expression::Opcode opcode, double operand = 0);
+    bool number(const Operand& operand, const QString& name);
+    void resolveTeam(const Operand& text);
+};
+
+ExpressionParser::ExpressionParser(const QString& text) :
+    m_text(text),
+    m_position(0),
+    m_kind(End),
+    m_number(0),
+    m_tokenPosition(0),
+    m_program(nullptr),
+    m_depth(0),
+    m_aggregates(nullptr),
+    m_insideAggregate(false),
+    m_columnOutside(false)
+{
+}
+
+bool ExpressionParser::parse(Expression& expression)
+{
+    m_program = &expression.m_program;
+    m_aggregates = &expression.m_aggregates;
+
+    next();
+
+    Operand result;
+    if(!parseOr(result))
+        return false;
+
+    if(m_kind != End)
+        return fail("unexpected '" + m_token + "'");
+    if(!number(result, "the result"))
+        return false;
+    if(m_columnOutside && !m_aggregates->isEmpty())
+        return fail("in a metric every column must be inside sum(), avg(), min(), max() or count()");
+
+    expression.m_amount = result.type == Money;
+    return true;
+}
+
+void ExpressionParser::next()
+{
+    while(m_position < m_text.size() && m_text.at(m_position).isSpace())
+        m_position++;
+
+    m_tokenPosition = m_position;
+    m_token.clear();
+
+    if(m_position >= m_text.size()) {
+        m_kind = End;
+        return;
+    }
+
+    QChar c = m_text.at(m_position);
+
+    if(c.isDigit() || (c == '.' && m_position + 1 < m_text.size() && m_text.at(m_position + 1).isDigit())) {
+        int start = m_position;
+        while(m_position < m_text.size() && (m_text.at(m_position).isDigit() || m_text.at(m_position) == '.'))
+            m_position++;
+
+        if(m_position < m_text.size() && (m_text.at(m_position) == 'e' || m_text.at(m_position) == 'E')) {
+            int exponent = m_position + 1;
+            if(exponent < m_text.size() && (m_text.at(exponent) == '+' || m_text.at(exponent) == '-'))
+                exponent++;
+            if(exponent < m_text.size() && m_text.at(exponent).isDigit()) {
+                m_position = exponent;
+                while(m_position < m_text.size() && m_text.at(m_position).isDigit())
+                    m_position++;
+            }
+        }
+
+        bool ok;
+        m_token = m_text.mid(start, m_position - start);
+        m_number = m_token.toDouble(&ok);
+        m_kind = ok ? NumberToken : End;
+        if(!ok)
+            fail("bad number '" + m_token + "'");
+        return;
+    }
+
+    if(c == '"' || c == '\'') {
+        int end = m_text.indexOf(c, m_position + 1);
+        if(end == -1) {
+            m_kind = End;
+            fail("unterminated text");
+            return;
+        }
+
+        m_token = m_text.mid(m_position + 1, end - m_position - 1);
+        m_position = end + 1;
+        m_kind = StringToken;
+        return;
+    }
+
+    if(c.isLetter() || c == '_') {
+        int start = m_position;
+        while(m_position < m_text.size() && (m_text.at(m_position).isLetterOrNumber() || m_text.at(m_position) == '_'))
+            m_position++;
+
+        m_token = m_text.mid(start, m_position - start);
+        m_kind = Identifier;
+        return;
+    }
+
+    static const char* twoCharacters[] = { "==", "!=", "<=", ">=", "&&", "||" };
+    for(int i = 0; i < 6; i++) {
+        if(m_text.midRef(m_position, 2) == QLatin1String(twoCharacters[i])) {
+            m_token = QLatin1String(twoCharacters[i]);
+            m_position += 2;
+            m_kind = Symbol;
+            return;
+        }
+    }
+
+    if(QString("+-*/%<>!(),").contains(c)) {
+        m_token = c;
+        m_position++;
+        m_kind = Symbol;
+        return;
+    }
+
+    m_kind = End;
+    fail(QString("unexpected character '") + c + "'");
+}
+
+bool ExpressionParser::accept(const QString& symbol)
+{
+    if((m_kind == Symbol || m_kind == Identifier) && m_token == symbol) {
+        next();
+        return true;
+    }
+
+    return false;
+}
+
+bool ExpressionParser::expect(const QString& symbol)
+{
+    if(accept(symbol))
+        return true;
+
+    return fail("expected '" + symbol + "'");
+}
+
+bool ExpressionParser::fail(const QString& message)
+{
+    //The first error is the useful one
+    if(m_error.isEmpty())
+        m_error = message + " at position " + QString::number(m_tokenPosition + 1);
+
+    return false;
+}
+
+bool ExpressionParser::parseOr(Operand& result)
+{
+    if(!parseAnd(result))
+        return false;
+
+    while(accept("||") || accept("or")) {
+        Operand right;
+        if(!parseAnd(right) || !number(result, "or") || !number(right, "or"))
+            return false;
+
+        emitInstruction(Expression::Or);
+        result.type = Number;
+    }
+
+    return true;
+}
+
+bool ExpressionParser::parseAnd(Operand& result)
+{
+    if(!parseComparison(result))
+        return false;
+
+    while(accept("&&") || accept("and")) {
+        Operand right;
+        if(!parseComparison(right) || !number(result, "and") || !number(right, "and"))
+            return false;
+
+        emitInstruction(Expression::And);
+        result.type = Number;
+    }
+
+    return true;
+}
+
+bool ExpressionParser::parseComparison(Operand& result)
+{
+    if(!parseSum(result))
+        return false;
+
+    static const char* symbols[] = { "==", "!=", "<=", ">=", "<", ">" };
+    static const Expression::Opcode opcodes[] = { Expression::Equal, Expression::NotEqual, Expression::LessEqual,
+                                                  Expression::GreaterEqual, Expression::Less, Expression::Greater };
+
+    for(int i = 0; i < 6; i++) {
+        if(!accept(symbols[i]))
+            continue;
+
+        Operand right;
+        if(!parseSum(right))
+            return false;
+
+        if(i < 2) {
+            //Team names become team ids, so the comparison runs on numbers like any other
+            if(result.type == Team && right.type == Text)
+                resolveTeam(right);
+            else if(result.type == Text && right.type == Team)
+                resolveTeam(result);
+            else if((result.type == Team) != (right.type == Team) || result.type == Text || right.type == Text)
+                return fail("text can only be compared with winners or losers");
+        }
+        else if(!number(result, symbols[i]) || !number(right, symbols[i]))
+            return false;
+
+        emitInstruction(opcodes[i]);
+        result.type = Number;
+        break;
+    }
+
+    return true;
+}
+
+bool ExpressionParser::parseSum(Operand& result)
+{
+    if(!parseProduct(result))
+        return false;
+
+    while(m_kind == Symbol && (m_token == "+" || m_token == "-")) {
+        Expression::Opcode opcode = m_token == "+" ? Expression::Add : Expression::Subtract;
+        QString name = m_token;
+        next();
+
+        Operand right;
+        if(!parseProduct(right) || !number(result, name) || !number(right, name))
+            return false;
+
+        emitInstruction(opcode);
+        if(right.type == Money)
+            result.type = Money;
+    }
+
+    return true;
+}
+
+bool ExpressionParser::parseProduct(Operand& result)
+{
+    if(!parseUnary(result))
+        return false;
+
+    while(m_kind == Symbol && (m_token == "*" || m_token == "/" || m_token == "%")) {
+        Expression::Opcode opcode = m_token == "*" ? Expression::Multiply : m_token == "/" ? Expression::Divide : Expression::Modulo;
+        QString name = m_token;
+        next();
+
+        Operand right;
+        if(!parseUnary(right) || !number(result, name) || !number(right, name))
+            return false;
+
+        emitInstruction(opcode);
+
+        //Money times a number stays money, money divided by money is a ratio
+        if(opcode == Expression::Multiply)
+            result.type = (result.type == Money) != (right.type == Money) ? Money : Number;
+        else if(right.type == Money)
+            result.type = Number;
+    }
+
+    return true;
+}
+
+bool ExpressionParser::parseUnary(Operand& result)
+{
+    int start = m_program->code.size();
+
+    if(accept("-")) {
+        if(!parseUnary(result) || !number(result, "-"))
+            return false;
+
+        emitInstruction(Expression::Negate);
+        result.start = start;
+        return true;
+    }
+
+    if(accept("!") || accept("not")) {
+        if(!parseUnary(result) || !number(result, "not"))
+            return false;
+
+        emitInstruction(Expression::Not);
+        result.start = start;
+        result.type = Number;
+        return true;
+    }
+
+    return parsePrimary(result);
+}
+
+bool ExpressionParser::parsePrimary(Operand& result)
+{
+    result.type = Number;
+    result.start = m_program->code.size();
+
+    if(m_kind == NumberToken) {
+        emitInstruction(Expression::PushConstant, m_number);
+        next();
+        return true;
+    }
+
+    if(m_kind == StringToken) {
+        //Placeholder, patched with a team id once the comparison is known
+        emitInstruction(Expression::PushConstant, -1);
+        result.type = Text;
+        result.text = m_token;
+        next();
+        return true;
+    }
+
+    if(accept("(")) {
+        int start = result.start;
+        if(!parseOr(result) || !expect(")"))
+            return false;
+
+        result.start = start;
+        return true;
+    }
+
+    if(m_kind != Identifier)
+        return fail(m_kind == End ? "unexpected end" : "unexpected '" + m_token + "'");
+
+    QString name = m_token;
+    next();
+
+    static const char* columns[] = { "amount", "day", "winners", "losers", "won", "id" };
+    for(int i = 0; i < 6; i++) {
+        if(name == QLatin1String(columns[i])) {
+            if(!m_insideAggregate)
+                m_columnOutside = true;
+
+            emitInstruction(Expression::PushColumn, i);
+            if(i == Expression::WinnersColumn || i == Expression::LosersColumn)
+                result.type = Team;
+            else if(i == Expression::AmountColumn)
+                result.type = Money;
+            return true;
+        }
+    }
+
+    if(name == "today") {
+        //Read when the expression runs, so a session left open past midnight keeps moving
+        emitInstruction(Expression::PushToday);
+        return true;
+    }
+
+    if(name == "abs") {
+        if(!expect("(") || !parseOr(result) || !number(result, "abs()") || !expect(")"))
+            return false;
+
+        emitInstruction(Expression::Absolute);
+        return true;
+    }
+
+    if(name == "date") {
+        if(!expect("("))
+            return false;
+        if(m_kind != StringToken)
+            return fail("date() needs a date in quotes");
+
+        QDate date = QDate::fromString(m_token, "yyyy.MM.dd");
+        if(!date.isValid())
+            return fail("'" + m_token + "' is not a yyyy.MM.dd date");
+
+        next();
+        emitInstruction(Expression::PushConstant, date.toJulianDay());
+        return expect(")");
+    }
+
+    if(name == "sum") return parseAggregate(Expression::Sum, result);
+    if(name == "avg") return parseAggregate(Expression::Average, result);
+    if(name == "min") return parseAggregate(Expression::Minimum, result);
+    if(name == "max") return parseAggregate(Expression::Maximum, result);
+    if(name == "count") return parseAggregate(Expression::Count, result);
+
+    return fail("unknown name '" + name + "'");
+}
+
+bool ExpressionParser::parseAggregate(Expression::AggregateKind kind, Operand& result)
+{
+    if(m_insideAggregate)
+        return fail("aggregates cannot be nested");
+    if(!expect("("))
+        return false;
+
+    Expression::Aggregate aggregate;
+    aggregate.kind = kind;
+    aggregate.filtered = false;
+
+    m_insideAggregate = true;
+
+    bool ok = true;
+    Type type = Number;
+    if(kind != Expression::Count) {
+        ok = parseInto(aggregate.value, "the aggregated value", &type);
+        if(ok && accept(",")) {
+            ok = parseInto(aggregate.filter, "the filter");
+            aggregate.filtered = true;
+        }
+    }
+    else if(!(m_kind == Symbol && m_token == ")")) {
+        ok = parseInto(aggregate.filter, "the filter");
+        aggregate.filtered = true;
+    }
+
+    m_insideAggregate = false;
+
+    if(!ok || !expect(")"))
+        return false;
+
+    m_aggregates->append(aggregate);
+    emitInstruction(Expression::PushAggregate, m_aggregates->size() - 1);
+
+    //Sums, averages and extremes of money are money, counts are not
+    result.type = type;
+    return true;
+}
+
+bool ExpressionParser::parseInto(Expression::Program& program, const QString& name, Type* type)
+{
+    //Aggregate arguments are separate programs, run over the whole store
+    Expression::Program* outer = m_program;
+    int outerDepth = m_depth;
+
+    m_program = &program;
+    m_depth = 0;
+
+    Operand operand;
+    bool ok = parseOr(operand) && number(operand, name);
+    if(ok && type != nullptr)
+        *type = operand.type;
+
+    m_program = outer;
+    m_depth = outerDepth;
+
+    return ok;
+}
+
+void ExpressionParser::emitInstruction(Expression::Opcode opcode, double operand)
+{
+    Expression::Instruction instruction;
+    instruction.opcode = opcode;
+    instruction.operand = operand;
+    m_program->code.append(instruction);
+
+    //Pushes grow the stack, binary operators shrink it, unary ones keep it
+    if(opcode == Expression::PushColumn || opcode == Expression::PushConstant || opcode == Expression::PushToday ||
+       opcode == Expression::PushAggregate)
+        m_depth++;
+    else if(opcode != Expression::Negate && opcode != Expression::Absolute && opcode != Expression::Not)
+        m_depth--;
+
+    m_program->depth = qMax(m_program->depth, m_depth);
+}
+
+bool ExpressionParser::number(const Operand& operand, const QString& name)
+{
+    if(operand.type == Team)
+        return fail("winners and losers can only be compared with == and !=, not used in " + name);
+    if(operand.type == Text)
+        return fail("text can only be compared with winners or losers, not used in " + name);
+
+    return true;
+}
+
+void ExpressionParser::resolveTeam(const Operand& text)
+{
+    //Unknown names become -1, which matches no bet
+    TeamSymbols& symbols = TeamSymbols::instance();
+    m_program->code[text.start].operand = symbols.canonical(symbols.find(text.text));
+}
+
+Expression::Expression() :
+    m_valid(false),
+    m_amount(false)
+{
+}
+
+Expression Expression::compile(const QString& text, QString* error)
+{
+    Expression expression;
+    ExpressionParser parser(text);
+
+    expression.m_valid = parser.parse(expression);
+
+    if(!expression.m_valid) {
+        expression.m_program = Program();
+        expression.m_aggregates.clear();
+    }
+
+    if(error != nullptr)
+        *error = parser.error();
+
+    return expression;
+}
+
+QVector<double> Expression::evaluate(const BetStore& store, double scale) const
+{
+    if(!m_valid || isMetric())
+        return QVector<double>();
+
+    return run(m_program, store, scale, QVector<double>(), store.size());
+}
+
+double Expression::evaluateMetric(const BetStore& store, double scale) const
+{
+    if(!m_valid || !isMetric())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    QVector<double> values;
+    for(int i = 0; i < m_aggregates.size(); i++)
+        values.append(aggregate(m_aggregates.at(i), store, scale));
+
+    //Outside the aggregates a metric has no columns, one row is enough
+    return run(m_program, store, scale, values, 1).at(0);
+}
+
+QVector<double> Expression::run(const Program& program, const BetStore& store, double scale, const QVector<double>& aggregates, int size)
+{
+    QVector<double> result(size);
+    QVector<double> stack(qMax(program.depth, 1) * BatchSize);
+    const double today = QDate::currentDate().toJulianDay();
+
+    for(int base = 0; base < size; base += BatchSize) {
+        int length = qMin(BatchSize, size - base);
+        int top = 0;
+
+        for(int c = 0; c < program.code.size(); c++) {
+            const Instruction& instruction = program.code.at(c);
+
+            switch(instruction.opcode) {
+            case PushColumn: {
+                double* out = stack.data() + top++ * BatchSize;
+                int column = int(instruction.operand);
+
+                //Fixed-point units are scaled back, so amount means currency whichever mode is on
+                if(column == AmountColumn && store.isFixed()) {
+                    const qint64* units = store.units().constData() + base;
+                    for(int i = 0; i < length; i++)
+                        out[i] = units[i] / scale;
+                }
+                else if(column == AmountColumn)
+                    std::copy(store.amounts().constData() + base, store.amounts().constData() + base + length, out);
+                else if(column == WonColumn) {
+                    for(int i = 0; i < length; i++)
+                        out[i] = store.amount(base + i) >= 0 ? 1 : 0;
+                }
+                else {
+                    const QVector<int>& values = column == DayColumn ? store.days() :
+                                                 column == WinnersColumn ? store.winners() :
+                                                 column == LosersColumn ? store.losers() : store.ids();
+                    const int* in = values.constData() + base;
+                    for(int i = 0; i < length; i++)
+                        out[i] = in[i];
+                }
+                break;
+            }
+            case PushConstant:
+            case PushToday:
+            case PushAggregate: {
+                double* out = stack.data() + top++ * BatchSize;
+                double value = instruction.opcode == PushConstant ? instruction.operand :
+                               instruction.opcode == PushToday ? today : aggregates.at(int(instruction.operand));
+                std::fill(out, out + length, value);
+                break;
+            }
+            case Negate: {
+                double* x = stack.data() + (top - 1) * BatchSize;
+                for(int i = 0; i < length; i++) x[i] = -x[i];
+                break;
+            }
+            case Absolute: {
+                double* x = stack.data() + (top - 1) * BatchSize;
+                for(int i = 0; i < length; i++) x[i] = std::fabs(x[i]);
+                break;
+            }
+            case Not: {
+                double* x = stack.data() + (top - 1) * BatchSize;
+                for(int i = 0; i < length; i++) x[i] = x[i] == 0 ? 1 : 0;
+                break;
+            }
+            default: {
+                //Binary operators leave their result in the left operand's slot
+                top--;
+                double* a = stack.data() + (top - 1) * BatchSize;
+                const double* b = stack.constData() + top * BatchSize;
+
+                switch(instruction.opcode) {
+                case Add:          for(int i = 0; i < length; i++) a[i] += b[i]; break;
+                case Subtract:     for(int i = 0; i < length; i++) a[i] -= b[i]; break;
+                case Multiply:     for(int i = 0; i < length; i++) a[i] *= b[i]; break;
+                case Divide:       for(int i = 0; i < length; i++) a[i] /= b[i]; break;
+                case Modulo:       for(int i = 0; i < length; i++) a[i] = std::fmod(a[i], b[i]); break;
+                case Less:         for(int i = 0; i < length; i++) a[i] = a[i] < b[i] ? 1 : 0; break;
+                case LessEqual:    for(int i = 0; i < length; i++) a[i] = a[i] <= b[i] ? 1 : 0; break;
+                case Greater:      for(int i = 0; i < length; i++) a[i] = a[i] > b[i] ? 1 : 0; break;
+                case GreaterEqual: for(int i = 0; i < length; i++) a[i] = a[i] >= b[i] ? 1 : 0; break;
+                case Equal:        for(int i = 0; i < length; i++) a[i] = a[i] == b[i] ? 1 : 0; break;
+                case NotEqual:     for(int i = 0; i < length; i++) a[i] = a[i] != b[i] ? 1 : 0; break;
+                case And:          for(int i = 0; i < length; i++) a[i] = a[i] != 0 && b[i] != 0 ? 1 : 0; break;
+                case Or:           for(int i = 0; i < length; i++) a[i] = a[i] != 0 || b[i] != 0 ? 1 : 0; break;
+                default: break;
+                }
+                break;
+            }
+            }
+        }
+
+        std::copy(stack.constData(), stack.constData() + length, result.data() + base);
+    }
+
+    return result;
+}
+
+double Expression::aggregate(const Aggregate& aggregate, const BetStore& store, double scale)
+{
+    int size = store.size();
+
+    QVector<double> values, filter;
+    if(aggregate.kind != Count)
+        values = run(aggregate.value, store, scale, QVector<double>(), size);
+    if(aggregate.filtered)
+        filter = run(aggregate.filter, store, scale, QVector<double>(), size);
+
+    //Derived values are not amounts and need not fit ExactSum, Neumaier summation keeps them accurate
+    double sum = 0, compensation = 0;
+    double minimum = std::numeric_limits<double>::infinity(), maximum = -std::numeric_limits<double>::infinity();
+    int count = 0;
+
+    for(int i = 0; i < size; i++) {
+        if(aggregate.filtered && filter.at(i) == 0)
+            continue;
+
+        count++;
+        if(aggregate.kind == Count)
+            continue;
+
+        double value = values.at(i);
+        double total = sum + value;
+        compensation += std::fabs(sum) >= std::fabs(value) ? (sum - total) + value : (value - total) + sum;
+        sum = total;
+
+        minimum = qMin(minimum, value);
+        maximum = qMax(maximum, value);
+    }
+
+    const double none = std::numeric_limits<double>::quiet_NaN();
+
+    switch(aggregate.kind) {
+    case Sum: return sum + compensation;
+    case Average: return count == 0 ? none : (sum + compensation) / count;
+    case Minimum: return count == 0 ? none : minimum;
+    case Maximum: return count == 0 ? none : maximum;
+    case Count: return count;
+    }
+
+    return none;
+}
@@ -0,0 +1,87 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <QString>
+#include <QVector>
+#include "betstore.h"
+
+//User-defined column or metric over the bet store.
+//
+//Columns: amount (in currency, also in fixed-point mode), day (julian day),
+//winners, losers, won (1 or 0), id.
+//Constants: numbers, today, date("yyyy.MM.dd"), team names in quotes
+//(only compared with winners/losers using == and !=).
+//Operators: + - * / %, comparisons, && || ! (also and, or, not), abs(x).
+//Aggregates turn the expression into a metric: sum(x), avg(x), min(x),
+//max(x) and count(), each with an optional filter argument, e.g.
+//count(winners == "NiP" && day > today - 30) or sum(amount) / count().
+//
+//Expressions compile to stack bytecode. The interpreter runs every
+//instruction over a whole batch of rows at a time, so dispatch is paid once
+//per batch and the inner loops are plain array arithmetic.
+class Expression
+{
+public:
+    Expression();
+
+    static Expression compile(const QString& text, QString* error = 0);
+
+    bool isValid() const { return m_valid; }
+    bool isMetric() const { return !m_aggregates.isEmpty(); }
+
+    //Whether the result is money (derived from amount), for formatting
+    bool isAmount() const { return m_amount; }
+
+    //Value of a column expression for every bet, in store order. amount is always in
+    //currency; scale is the number of fixed-point units per currency unit of the store
+    QVector<double> evaluate(const BetStore& store, double scale = 1) const;
+
+    //Value of a metric expression over all bets of the store
+    double evaluateMetric(const BetStore& store, double scale = 1) const;
+
+private:
+    friend class ExpressionParser;
+
+    enum Opcode
+    {
+        PushColumn, PushConstant, PushToday, PushAggregate,
+        Add, Subtract, Multiply, Divide, Modulo, Negate, Absolute,
+        Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual,
+        And, Or, Not
+    };
+
+    enum Column { AmountColumn, DayColumn, WinnersColumn, LosersColumn, WonColumn, IdColumn };
+    enum AggregateKind { Sum, Average, Minimum, Maximum, Count };
+
+    struct Instruction
+    {
+        Opcode opcode;
+        double operand;
+    };
+
+    struct Program
+    {
+        Program() : depth(0) {}
+
+        QVector<Instruction> code;
+        int depth;
+    };
+
+    struct Aggregate
+    {
+        AggregateKind kind;
+        Program value;
+        Program filter;
+        bool filtered;
+    };
+
+    bool m_valid;
+    bool m_amount;
+    Program m_program;
+    QVector<Aggregate> m_aggregates;
+
+    static QVector<double> run(const Program& program, const BetStore& store, double scale, const QVector<double>& aggregates, int size);
+    static double aggregate(const Aggregate& aggregate, const BetStore& store, double scale);
+};
+
+#endif // EXPRESSION_H
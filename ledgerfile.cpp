@@ -0,0 +1,149 @@
+#include "ledgerfile.h"
+#include <QStringList>
+#include <limits>
+
+namespace {
+
+const qint64 ScanBufferSize = 1 << 20;
+
+}
+
+LedgerFile::LedgerFile() :
+    m_rows(0),
+    m_size(0),
+    m_indexed(0),
+    m_lineStart(true)
+{
+    setCacheLimit(64 << 20);
+}
+
+bool LedgerFile::open(const QString& path, QString* error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly)) {
+        if(error != nullptr)
+            *error = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    return true;
+}
+
+bool LedgerFile::indexMore()
+{
+    if(isIndexed())
+        return true;
+
+    //Block reads move the file position, so every buffer seeks back to where indexing stopped
+    QByteArray buffer;
+    if(m_file.seek(m_indexed))
+        buffer = m_file.read(ScanBufferSize);
+
+    //A file cut short while open is indexed up to where it ends
+    if(buffer.isEmpty()) {
+        m_size = m_indexed;
+        return true;
+    }
+
+    //Only line starts are looked at; a block offset is kept for every BlockRows lines
+    const char* data = buffer.constData();
+    for(int i = 0; i < buffer.size(); i++) {
+        if(m_lineStart) {
+            if(m_rows % BlockRows == 0)
+                m_offsets.append(m_indexed + i);
+            m_rows++;
+            m_lineStart = false;
+        }
+        if(data[i] == '\n')
+            m_lineStart = true;
+    }
+
+    m_indexed += buffer.size();
+    return isIndexed();
+}
+
+void LedgerFile::close()
+{
+    m_cache.clear();
+    m_uncached.reset();
+    m_offsets.clear();
+    m_rows = 0;
+    m_size = 0;
+    m_indexed = 0;
+    m_lineStart = true;
+
+    if(m_file.isOpen())
+        m_file.close();
+}
+
+void LedgerFile::setCacheLimit(qint64 bytes)
+{
+    //QCache costs are ints, so they are counted in kilobytes
+    m_cache.setMaxCost(int(qBound(Q_INT64_C(1), bytes / 1024, qint64(std::numeric_limits<int>::max()))));
+}
+
+const LedgerFile::Block* LedgerFile::block(int index)
+{
+    Block* cached = m_cache.object(index);
+    if(cached != nullptr)
+        return cached;
+
+    Block* block = new Block;
+    if(!read(index, *block)) {
+        delete block;
+        return nullptr;
+    }
+
+    //A block larger than the whole cap is still handed out, just never cached
+    int cost = int(block->bytes / 1024) + 1;
+    if(cost > m_cache.maxCost()) {
+        m_uncached.reset(block);
+        return block;
+    }
+
+    m_cache.insert(index, block, cost);
+    return block;
+}
+
+QString LedgerFile::cell(qint64 row, int column)
+{
+    if(row < 0 || row >= m_rows || column < 0 || column >= Columns)
+        return QString();
+
+    const Block* rows = block(int(row / BlockRows));
+    if(rows == nullptr)
+        return QString();
+
+    return rows->cells.at(int(row % BlockRows) * Columns + column);
+}
+
+bool LedgerFile::read(int index, Block& block)
+{
+    if(index < 0 || index >= indexedBlockCount() || !m_file.seek(m_offsets.at(index)))
+        return false;
+
+    qint64 first = qint64(index) * BlockRows;
+    block.rows = int(qMin(qint64(BlockRows), m_rows - first));
+    block.cells = QVector<QString>(block.rows * Columns);
+    block.bytes = sizeof(Block) + block.cells.size() * qint64(sizeof(QString));
+
+    for(int row = 0; row < block.rows; row++) {
+        QByteArray line = m_file.readLine();
+        if(line.endsWith('\n'))
+            line.chop(1);
+        if(line.endsWith('\r'))
+            line.chop(1);
+
+        //Same tokenizing as loading into the table
+        QStringList tokens = QString::fromUtf8(line).split(";", QString::SkipEmptyParts);
+        for(int column = 0; column < qMin(int(Columns), tokens.size()); column++) {
+            block.cells[row * Columns + column] = tokens.at(column);
+            block.bytes += tokens.at(column).size() * 2 + 24;
+        }
+    }
+
+    return true;
+}
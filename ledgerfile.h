@@ -0,0 +1,67 @@
+#ifndef LEDGERFILE_H
+#define LEDGERFILE_H
+
+#include <QFile>
+#include <QVector>
+#include <QString>
+#include <QCache>
+#include <QScopedPointer>
+
+//Read-only view of a ledger file that is never loaded as a whole. After opening,
+//indexMore() scans for line breaks a buffer at a time and remembers where every
+//block of BlockRows rows starts, so a caller can spread indexing over the event
+//loop; blocks are parsed on demand and kept in an LRU cache whose size is capped,
+//so memory stays bounded by the cap however large the file is.
+class LedgerFile
+{
+public:
+    static const int BlockRows = 4096;
+    static const int Columns = 4;
+
+    struct Block
+    {
+        //Row-major cells, rows with missing cells are padded with empty strings
+        QVector<QString> cells;
+        int rows;
+        qint64 bytes;
+    };
+
+    LedgerFile();
+
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    //Indexes the next buffer of the file, returns true once the whole file is indexed
+    bool indexMore();
+    bool isIndexed() const { return m_indexed >= m_size; }
+    qint64 indexedBytes() const { return m_indexed; }
+    qint64 size() const { return m_size; }
+
+    //Rows and blocks found so far; only complete blocks can be read while indexing
+    qint64 rowCount() const { return m_rows; }
+    int blockCount() const { return m_offsets.size(); }
+    int indexedBlockCount() const { return isIndexed() ? m_offsets.size() : qMax(0, m_offsets.size() - 1); }
+
+    void setCacheLimit(qint64 bytes);
+    qint64 cacheLimit() const { return qint64(m_cache.maxCost()) * 1024; }
+
+    //Cached block; the pointer is only valid until the next call
+    const Block* block(int index);
+    QString cell(qint64 row, int column);
+
+    //Parses a block without touching the cache, for one-pass scans that would only evict it
+    bool read(int index, Block& block);
+
+private:
+    QFile m_file;
+    QVector<qint64> m_offsets;
+    qint64 m_rows;
+    qint64 m_size;
+    qint64 m_indexed;
+    bool m_lineStart;
+    QCache<int, Block> m_cache;
+    QScopedPointer<Block> m_uncached;
+};
+
+#endif // LEDGERFILE_H
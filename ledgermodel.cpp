@@ -0,0 +1,70 @@
+#include "ledgermodel.h"
+#include <QStringList>
+#include <limits>
+
+LedgerModel::LedgerModel(LedgerFile* ledger, QObject* parent) :
+    QAbstractTableModel(parent),
+    m_ledger(ledger),
+    m_rows(0),
+    m_readableRows(0)
+{
+    refresh();
+}
+
+int LedgerModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+void LedgerModel::refresh()
+{
+    //Item views address rows with ints, anything past that is left out of the view
+    int rows = int(qMin(m_ledger->rowCount(), qint64(std::numeric_limits<int>::max())));
+    if(rows > m_rows) {
+        beginInsertRows(QModelIndex(), m_rows, rows - 1);
+        m_rows = rows;
+        endInsertRows();
+    }
+
+    int readable = readableRows();
+    if(readable > m_readableRows) {
+        int first = m_readableRows;
+        m_readableRows = readable;
+        emit dataChanged(index(first, 0), index(readable - 1, LedgerFile::Columns - 1));
+    }
+}
+
+int LedgerModel::readableRows() const
+{
+    qint64 rows = qMin(m_ledger->rowCount(), qint64(m_ledger->indexedBlockCount()) * LedgerFile::BlockRows);
+    return int(qMin(rows, qint64(m_rows)));
+}
+
+int LedgerModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : LedgerFile::Columns;
+}
+
+QVariant LedgerModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    if(index.row() >= m_readableRows)
+        return index.column() == 0 ? QVariant("Loading...") : QVariant();
+
+    return m_ledger->cell(index.row(), index.column());
+}
+
+QVariant LedgerModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(role != Qt::DisplayRole)
+        return QVariant();
+
+    if(orientation == Qt::Vertical)
+        return section + 1;
+
+    QStringList headers;
+    headers << "Date" << "Winners" << "Losers" << "Amount";
+    return headers.value(section);
+}
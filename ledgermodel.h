@@ -0,0 +1,33 @@
+#ifndef LEDGERMODEL_H
+#define LEDGERMODEL_H
+
+#include <QAbstractTableModel>
+#include "ledgerfile.h"
+
+//Read-only table over a LedgerFile. The view only asks for the rows it shows,
+//so scrolling pages blocks in and out of the ledger's cache. Rows appear as the
+//ledger is indexed; rows of a block that is not fully indexed yet show as loading.
+class LedgerModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit LedgerModel(LedgerFile* ledger, QObject* parent = 0);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    //Picks up rows and blocks indexed since the last call
+    void refresh();
+
+private:
+    LedgerFile* m_ledger;
+    int m_rows;
+    int m_readableRows;
+
+    int readableRows() const;
+};
+
+#endif // LEDGERMODEL_H
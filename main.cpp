@@ -1,14 +1,14 @@
-#include "mainwindow.h"
-#include <QApplication>
-
-int main(int argc, char *argv[])
-{
-    QApplication a(argc, argv);
-
-    MainWindow w;
-    w.setWindowTitle("Betting Statistics");
-
-    w.show();
-
-    return a.exec();
-}
+#include "mainwindow.h"
+#include <QApplication>
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    MainWindow w;
+    w.setWindowTitle("Betting Statistics");
+
+    w.show();
+
+    return a.exec();
+}
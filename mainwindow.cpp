@@ -1,510 +1,1453 @@
-#include "mainwindow.h"
-#include "ui_mainwindow.h"
-#include <QDate>
-#include <QTextStream>
-#include <QString>
-#include <QDebug>
-#include <QFileDialog>
-#include <QMessageBox>
-#include <QCloseEvent>
-#include <QRegExpValidator>
-#include <QList>
-#include <QVector>
-#include <QPen>
-#include <QColor>
-
-MainWindow::MainWindow(QWidget *parent) :
-    QMainWindow(parent),
-    ui(new Ui::MainWindow),
-    m_table(nullptr),
-    m_currentFile(nullptr),
-    m_saved(true)
-{
-    //Reset focus
-    setFocus();
-
-    //UI Setup
-    ui->setupUi(this);
-
-    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
-
-    ui->dateEdit->setDate(QDate::currentDate());
-
-    QRegExpValidator* validator = new QRegExpValidator(QRegExp("[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?"), this);
-    ui->amountLineEdit->setValidator(validator);
-
-    //Update the table
-    if(getLastFilePath() == "") disableUi();
-    m_currentFile = new QFile(getLastFilePath());
-
-    if(m_currentFile->fileName() == "" || !m_currentFile->exists()) disableUi();
-
-    loadTable();
-    setupPlot();
-
-    //Signals & slots
-    connect(m_table, SIGNAL(itemChanged(QStandardItem*)), this, SLOT(tableChanged()));
-    connect(m_table, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)), this, SLOT(tableChanged()));
-
-    connect(ui->actionNew, SIGNAL(triggered(bool)), this, SLOT(newFile()));
-    connect(ui->actionSave, SIGNAL(triggered(bool)), this, SLOT(save()));
-    connect(ui->actionSave_as, SIGNAL(triggered(bool)), this, SLOT(saveAs()));
-    connect(ui->actionOpen, SIGNAL(triggered(bool)), this, SLOT(open()));
-    connect(ui->actionExit, SIGNAL(triggered(bool)), this, SLOT(close()));
-    connect(ui->actionAbout_Qt, SIGNAL(triggered(bool)), this, SLOT(aboutQt()));
-    connect(ui->actionAbout, SIGNAL(triggered(bool)), this, SLOT(about()));
-
-    connect(ui->addButton, SIGNAL(clicked(bool)), this, SLOT(add()));
-    connect(ui->removeButton, SIGNAL(clicked(bool)), this, SLOT(remove()));
-    connect(ui->resetGraphButton, SIGNAL(clicked(bool)), this, SLOT(resetGraph()));
-}
-
-MainWindow::~MainWindow()
-{
-    delete ui;
-}
-
-void MainWindow::closeEvent(QCloseEvent* event)
-{
-    event->ignore();
-    close();
-}
-
-void MainWindow::loadTable()
-{
-    //Setting up the table & loading from file
-    m_table = new QStandardItemModel;
-
-    m_table->setHorizontalHeaderItem(0, new QStandardItem(QString("Date")));
-    m_table->setHorizontalHeaderItem(1, new QStandardItem(QString("Winners")));
-    m_table->setHorizontalHeaderItem(2, new QStandardItem(QString("Losers")));
-    m_table->setHorizontalHeaderItem(3, new QStandardItem(QString("Amount")));
-
-
-    if(!m_currentFile->open(QIODevice::ReadOnly)) {
-        qDebug() << m_currentFile->errorString();
-        return;
-    }
-
-
-    QTextStream in(m_currentFile);
-    unsigned int row = 0;
-    while(!in.atEnd()) {
-        QString line = in.readLine();
-
-        //parse the line into separate pieces(tokens) with ";" as the delimiter
-        QStringList lineToken = line.split(";", QString::SkipEmptyParts);
-
-        // load parsed data to model accordingly
-        for (int column = 0; column < lineToken.size(); column++) {
-            QString value = lineToken.at(column);
-            QStandardItem *item = new QStandardItem(value);
-
-            //add item to the model (row, column, item)
-            m_table->setItem(row, column, item);
-        }
-
-        row++;
-    }
-    m_currentFile->close();
-
-    ui->tableView->setModel(m_table);
-    updateValues();
-}
-
-void MainWindow::updateValues()
-{
-    if(m_table->rowCount() == 0)
-        return;
-
-    //Total bets
-    //Bets won
-    //Bets lost
-    //Total money
-    //Money won
-    //Money lost
-    //Max won
-    //Max lost
-    //Best team
-    //Worst team
-
-    int betsWon = 0, betsLost = 0;
-    double totalMoney = 0, moneyWon = 0, moneyLost = 0;
-    double maxWon = 0, maxLost = 0;
-
-    //Money
-    for(int i = 0; i < m_table->rowCount(); i++) {
-        QString string = m_table->item(i, 3)->text();
-        double value = string.toDouble();
-
-        if(value >= 0) {
-            betsWon++;
-            moneyWon += value;
-
-            if(i == 0) maxWon = value;
-            else if(value > maxWon) maxWon = value;
-        }
-        else if(value < 0) {
-            betsLost++;
-            moneyLost += value;
-
-            if(i == 0) maxLost = value;
-            else if(value < maxLost) maxLost = value;
-        }
-
-        totalMoney += value;
-    }
-
-    updateBestWorstTeams();
-
-    ui->totalBetsLineEdit->setText(QString::number(m_table->rowCount()));
-    ui->betsLostLineEdit->setText(QString::number(betsLost));
-    ui->betsWonLineEdit->setText(QString::number(betsWon));
-    ui->totalMoneyLineEdit->setText(QString::number(totalMoney));
-    ui->moneyLostLineEdit->setText(QString::number(moneyLost));
-    ui->moneyWonLineEdit->setText(QString::number(moneyWon));
-    ui->maxWonLineEdit->setText(QString::number(maxWon));
-    ui->maxLostLineEdit->setText(QString::number(maxLost));
-}
-
-void MainWindow::updateBestWorstTeams()
-{
-    int maxWins = 0, bestTeamWinsRow = 0;
-    int maxLosses = 0, worstTeamRow = 0;
-    double maxMostMoney = 0;
-    int bestTeamMoneyRow = 0;
-    for(int i = 0; i < m_table->rowCount(); i++) {
-        int wins = 0, losses = 0;
-        double mostMoney = 0;
-
-        for(int j = 0; j < m_table->rowCount(); j++) {
-            //Best
-            if(m_table->item(i, 1)->text().toUpper() == m_table->item(j, 1)->text().toUpper()) {
-                wins++;
-                mostMoney += m_table->item(j, 3)->text().toDouble();
-            }
-            //Worst
-            if(m_table->item(i, 2)->text().toUpper() == m_table->item(j, 2)->text().toUpper())
-                losses++;
-        }
-
-        if(wins >= maxWins) {
-            maxWins = wins;
-            bestTeamWinsRow = i;
-        }
-        if(losses >= maxLosses) {
-            maxLosses = losses;
-            worstTeamRow = i;
-        }
-        if(mostMoney >= maxMostMoney) {
-            maxMostMoney = mostMoney;
-            bestTeamMoneyRow = i;
-        }
-    }
-
-    ui->bestTeamWinsLineEdit->setText(m_table->item(bestTeamWinsRow, 1)->text() + " (" + QString::number(maxWins) + ")");
-    ui->bestTeamMoneyLineEdit->setText(m_table->item(bestTeamMoneyRow, 1)->text() + " (" + QString::number(maxMostMoney) + ")");
-    ui->worstTeamLossesLineEdit->setText(m_table->item(worstTeamRow, 2)->text() + " (" + QString::number(maxLosses) + ")");
-}
-
-void MainWindow::setupPlot()
-{
-    if(ui->plot->graphCount() > 0)
-        ui->plot->removeGraph(0);
-
-    ui->plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
-
-    ui->plot->addGraph();
-    ui->plot->graph(0)->setPen(QPen(QColor(30, 144, 255)));
-
-    ui->plot->xAxis->setVisible(false);
-    ui->plot->xAxis->setOffset(10);
-    ui->plot->xAxis->grid()->setPen(QPen(Qt::white));
-    ui->plot->xAxis->grid()->setZeroLinePen(QPen(Qt::white));
-
-    ui->plot->yAxis->setOffset(10);
-    ui->plot->yAxis->grid()->setPen(QPen(Qt::white));
-
-    ui->plot->xAxis2->setVisible(false);
-    ui->plot->xAxis2->setOffset(10);
-    ui->plot->xAxis2->setTicks(false);
-
-    ui->plot->yAxis2->setVisible(true);
-    ui->plot->yAxis2->setOffset(10);
-    ui->plot->yAxis2->setTicks(false);
-
-    updatePlotData();
-}
-
-void MainWindow::updatePlotData()
-{
-    QVector<double> x, y;
-    x.push_back(0);
-    y.push_back(0);
-
-    double total = 0;
-
-    for(int i = m_table->rowCount(); i > 0; i--) {
-        x.push_back(m_table->rowCount() + 1 - i);
-
-        total += m_table->item(i - 1, 3)->text().toDouble();
-        y.push_back(total);
-    }
-
-    ui->plot->graph(0)->setData(x, y);
-
-    ui->plot->xAxis->setRange(0, m_table->rowCount());
-    ui->plot->yAxis->setRange(ui->moneyLostLineEdit->text().toDouble(), ui->moneyWonLineEdit->text().toDouble());
-
-
-    ui->plot->replot();
-}
-
-void MainWindow::offerToSave()
-{
-    int result = QMessageBox::question(this, "Betting Statistics", "Changes unsaved. Would you like to save them?",
-                                       QMessageBox::Cancel | QMessageBox::No | QMessageBox::Yes,
-                                       QMessageBox::Yes);
-
-    if(result == QMessageBox::Yes)
-        save();
-    else
-        return;
-}
-
-QString MainWindow::getLastFilePath() const
-{
-    QFile file("lastfile.txt");
-    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << file.errorString();
-        return "";
-    }
-
-    QTextStream in(&file);
-    QString path = in.readLine();
-
-    file.close();
-
-    return path;
-}
-
-void MainWindow::enableUi()
-{
-    ui->dateEdit->setEnabled(true);
-    ui->amountLineEdit->setEnabled(true);
-    ui->winnersLineEdit->setEnabled(true);
-    ui->losersLineEdit->setEnabled(true);
-    ui->addButton->setEnabled(true);
-    ui->removeButton->setEnabled(true);
-
-    ui->plot->setEnabled(true);
-}
-
-void MainWindow::disableUi()
-{
-    ui->dateEdit->setEnabled(false);
-    ui->amountLineEdit->setEnabled(false);
-    ui->winnersLineEdit->setEnabled(false);
-    ui->losersLineEdit->setEnabled(false);
-    ui->addButton->setEnabled(false);
-    ui->removeButton->setEnabled(false);
-
-    ui->plot->removeGraph(0);
-    ui->plot->replot();
-    ui->plot->setEnabled(false);
-}
-
-//// Signals & slots /////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-void MainWindow::tableChanged()
-{
-    ui->tableView->sortByColumn(0, Qt::DescendingOrder);
-
-    m_saved = false;
-
-    updateValues();
-    updatePlotData();
-}
-
-void MainWindow::newFile()
-{
-    if(!m_saved) offerToSave();
-
-    QString path = QFileDialog::getSaveFileName(this, "New File", "./statistics.csv", "*.csv");
-    m_currentFile = new QFile(path);
-
-
-    if(!m_currentFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << m_currentFile->errorString();
-        return;
-    }
-
-    QTextStream out(m_currentFile);
-        out << ";";
-
-    m_currentFile->close();
-
-    enableUi();
-    loadTable();
-}
-
-void MainWindow::open()
-{
-    if(!m_saved) offerToSave();
-
-    QString selectedFilter = "CSV (*.csv)";
-    QString path = QFileDialog::getOpenFileName(this, "Open File", "./", "CSV (*.csv)", &selectedFilter);
-
-    m_currentFile = new QFile(path);
-
-    if(m_currentFile->fileName() == "") {
-        ui->tableView->setModel(nullptr);
-        disableUi();
-    }
-    else {
-        enableUi();
-        loadTable();
-        setupPlot();
-    }
-
-}
-
-void MainWindow::save()
-{
-    if(m_currentFile->fileName() == "") {
-        newFile();
-        return;
-    }
-
-    if(!m_currentFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << m_currentFile->errorString();
-        return;
-    }
-
-    QTextStream out(m_currentFile);
-    for(int row = 0; row < m_table->rowCount(); row++) {
-        for(int col = 0; col < 4; col++) {
-            out << m_table->item(row, col)->text() << ";";
-        }
-        out << "\n";
-    }
-
-    m_currentFile->close();
-
-    m_saved = true;
-}
-
-void MainWindow::saveAs()
-{
-    QString path = QFileDialog::getSaveFileName(this, "Save File", "./statistics.csv", "*.csv");
-
-    if(path != "") {
-        m_currentFile = new QFile(path);
-        save();
-    }
-}
-
-void MainWindow::close()
-{
-    //Save last file path
-    QFile file("lastfile.txt");
-
-    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-
-    QTextStream out(&file);
-    out << m_currentFile->fileName();
-
-    file.close();
-
-    //If changes saved, exit the application
-    if(m_saved) {
-        QApplication::exit();
-        return;
-    }
-
-    //If changes unsaved, ask if user would like to save them
-    int result = QMessageBox::question(this, "Betting Statistics", "Changes unsaved. Would you like to save them?",
-                                       QMessageBox::Cancel | QMessageBox::No | QMessageBox::Yes,
-                                       QMessageBox::Yes);
-
-    if(result == QMessageBox::Cancel)
-        return;
-    else if(result == QMessageBox::No)
-        QApplication::exit();
-    else if(result == QMessageBox::Yes) {
-        save();
-        QApplication::exit();
-    }
-}
-
-void MainWindow::about()
-{
-    QMessageBox::information(this, "About", "This program was made by dhmitry\nVersion 1.0.3", QMessageBox::Ok);
-}
-
-void MainWindow::aboutQt()
-{
-    qApp->aboutQt();
-}
-
-void MainWindow::add()
-{    
-    //Check if all information is entered
-    if(ui->dateEdit->date().toString("yyyy.MM.dd") == "" || ui->winnersLineEdit->text() == "" ||
-       ui->losersLineEdit->text() == "" || ui->amountLineEdit->text() == "") {
-        QMessageBox::information(this, "Betting Statistics", "You need to enter all information!");
-
-        return;
-    }
-
-    //Add new row
-    QStandardItem* date = new QStandardItem(ui->dateEdit->date().toString("yyyy.MM.dd"));
-    QStandardItem* winners = new QStandardItem(ui->winnersLineEdit->text());
-    QStandardItem* losers = new QStandardItem(ui->losersLineEdit->text());
-    QStandardItem* amount = new QStandardItem(ui->amountLineEdit->text());
-
-    QList<QStandardItem*> newRow;
-    newRow.append(date);
-    newRow.append(winners);
-    newRow.append(losers);
-    newRow.append(amount);
-
-    m_table->insertRow(m_table->rowCount(), newRow);
-
-    //Reset line edits
-    ui->winnersLineEdit->clear();
-    ui->losersLineEdit->clear();
-    ui->amountLineEdit->clear();
-
-
-    ui->tableView->sortByColumn(0, Qt::DescendingOrder);
-
-    m_saved = false;
-    updateValues();
-    updatePlotData();
-}
-
-void MainWindow::remove()
-{
-    QModelIndexList selection = ui->tableView->selectionModel()->selectedRows();
-
-    if(selection.count() == 0)
-        return;
-
-    while(!selection.isEmpty()) {
-        m_table->removeRow(selection.last().row());
-        selection.removeLast();
-    }
-
-
-    m_saved = false;
-    updateValues();
-    updatePlotData();
-}
-
-void MainWindow::resetGraph()
-{
-    updatePlotData();
-}
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+#include <QDate>
+#include <QTextStream>
+#include <QString>
+#include <QDebug>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QCloseEvent>
+#include <QRegExpValidator>
+#include <QList>
+#include <QVector>
+#include <QPen>
+#include <QColor>
+#include <QSettings>
+#include <QInputDialog>
+#include <QItemSelection>
+#include <QPair>
+#include <QAbstractItemView>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QRegularExpression>
+#include <QtNumeric>
+#include "teammatcher.h"
+#include <algorithm>
+
+//Stable id of a bet, stored on its date item so it survives sorting
+static const int BetIdRole = Qt::UserRole + 1;
+
+//Interned team id (see TeamSymbols), stored on the winners and losers items
+static const int TeamIdRole = Qt::UserRole + 2;
+
+//Number of most recent bets covered by the rolling statistics
+static const int RollingWindow = 50;
+
+//Full recompute of the mergeable aggregates and the chronological tree from a store
+static void computeAnalytics(const BetStore& store, BetAggregates& aggregates, RiskAnalytics& analytics)
+{
+    aggregates = BetAggregates::compute(store);
+
+    QVector<QPair<RiskAnalytics::Key, double> > bets;
+    bets.reserve(store.size());
+
+    for(int i = 0; i < store.size(); i++) {
+        RiskAnalytics::Key key;
+        key.day = store.days().at(i);
+        key.id = store.ids().at(i);
+        bets.append(qMakePair(key, store.amount(i)));
+    }
+
+    analytics.build(bets);
+}
+
+MainWindow::MainWindow(QWidget *parent) :
+    QMainWindow(parent),
+    ui(new Ui::MainWindow),
+    m_table(nullptr),
+    m_currentFile(nullptr),
+    m_saved(true),
+    m_selectionAggregatesDirty(true),
+    m_nextBetId(0),
+    m_teamSuggestions(new QStringListModel(this)),
+    m_filter(new BetFilterModel(this)),
+    m_betRowsDirty(true),
+    m_customSymbolsRevision(-1),
+    m_pivotDialog(nullptr),
+    m_simulation(new BankrollSimulation(this)),
+    m_bandHigh(nullptr),
+    m_bandLow(nullptr),
+    m_bandMedian(nullptr)
+{
+    //Reset focus
+    setFocus();
+
+    //UI Setup
+    ui->setupUi(this);
+
+    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    ui->dateEdit->setDate(QDate::currentDate());
+
+    ui->rollingLabel->setText("Last " + QString::number(RollingWindow) + " bets (win %)");
+
+    //Fixed-point amounts are opt-in, -1 means floating point
+    QSettings settings("dhmitry", "Betting Statistics");
+    m_moneyFormat = MoneyFormat(settings.value("fixedPointDecimals", -1).toInt());
+    ui->actionFixed_point_amounts->setChecked(m_moneyFormat.isFixed());
+    ui->actionLuck_bands->setChecked(settings.value("luckBands", false).toBool());
+
+    loadTeamAliases();
+    m_customDefinitions = settings.value("customExpressions").toStringList();
+    compileCustomExpressions();
+
+    QRegExpValidator* validator = new QRegExpValidator(QRegExp("[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?"), this);
+    ui->amountLineEdit->setValidator(validator);
+
+    setupTeamCompleter(ui->winnersLineEdit);
+    setupTeamCompleter(ui->losersLineEdit);
+    setupTeamCompleter(ui->filterTeamLineEdit);
+
+    ui->filterFromDateEdit->setDate(QDate::currentDate().addMonths(-1));
+    ui->filterToDateEdit->setDate(QDate::currentDate());
+
+    //Update the table
+    if(getLastFilePath() == "") disableUi();
+    m_currentFile = new QFile(getLastFilePath());
+
+    if(m_currentFile->fileName() == "" || !m_currentFile->exists()) disableUi();
+
+    loadTable();
+    setupPlot();
+
+    //Signals & slots
+    connect(ui->actionNew, SIGNAL(triggered(bool)), this, SLOT(newFile()));
+    connect(ui->actionSave, SIGNAL(triggered(bool)), this, SLOT(save()));
+    connect(ui->actionSave_as, SIGNAL(triggered(bool)), this, SLOT(saveAs()));
+    connect(ui->actionOpen, SIGNAL(triggered(bool)), this, SLOT(open()));
+    connect(ui->actionOpen_archive, SIGNAL(triggered(bool)), this, SLOT(openArchive()));
+    connect(ui->actionArchive_memory_cap, SIGNAL(triggered(bool)), this, SLOT(archiveMemoryCap()));
+    connect(ui->actionExit, SIGNAL(triggered(bool)), this, SLOT(close()));
+    connect(ui->actionAbout_Qt, SIGNAL(triggered(bool)), this, SLOT(aboutQt()));
+    connect(ui->actionAbout, SIGNAL(triggered(bool)), this, SLOT(about()));
+    connect(ui->actionFixed_point_amounts, SIGNAL(toggled(bool)), this, SLOT(fixedPointToggled(bool)));
+    connect(ui->actionMerge_team_aliases, SIGNAL(triggered(bool)), this, SLOT(mergeTeamAliases()));
+    connect(ui->actionClear_team_aliases, SIGNAL(triggered(bool)), this, SLOT(clearTeamAliases()));
+    connect(ui->actionPivot_table, SIGNAL(triggered(bool)), this, SLOT(showPivotTable()));
+    connect(ui->actionCustom_expressions, SIGNAL(triggered(bool)), this, SLOT(editCustomExpressions()));
+    connect(ui->actionLuck_bands, SIGNAL(toggled(bool)), this, SLOT(luckBandsToggled(bool)));
+    connect(m_simulation, SIGNAL(bandsChanged()), this, SLOT(updateLuckBands()));
+
+    connect(ui->addButton, SIGNAL(clicked(bool)), this, SLOT(add()));
+    connect(ui->removeButton, SIGNAL(clicked(bool)), this, SLOT(remove()));
+    connect(ui->resetGraphButton, SIGNAL(clicked(bool)), this, SLOT(resetGraph()));
+    connect(ui->quantileTeamComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(quantileTeamChanged()));
+    connect(ui->winnersLineEdit, SIGNAL(textEdited(QString)), this, SLOT(teamTextEdited(QString)));
+    connect(ui->losersLineEdit, SIGNAL(textEdited(QString)), this, SLOT(teamTextEdited(QString)));
+    connect(ui->filterTeamLineEdit, SIGNAL(textEdited(QString)), this, SLOT(teamTextEdited(QString)));
+
+    connect(ui->filterTeamLineEdit, SIGNAL(textChanged(QString)), this, SLOT(filterChanged()));
+    connect(ui->filterDatesCheckBox, SIGNAL(toggled(bool)), this, SLOT(filterChanged()));
+    connect(ui->filterFromDateEdit, SIGNAL(dateChanged(QDate)), this, SLOT(filterChanged()));
+    connect(ui->filterToDateEdit, SIGNAL(dateChanged(QDate)), this, SLOT(filterChanged()));
+    connect(ui->followFilterCheckBox, SIGNAL(toggled(bool)), this, SLOT(filterChanged()));
+}
+
+MainWindow::~MainWindow()
+{
+    delete ui;
+}
+
+void MainWindow::closeEvent(QCloseEvent* event)
+{
+    event->ignore();
+    close();
+}
+
+void MainWindow::loadTable()
+{
+    //Setting up the table & loading from file
+    m_table = new QStandardItemModel;
+
+    m_table->setHorizontalHeaderItem(0, new QStandardItem(QString("Date")));
+    m_table->setHorizontalHeaderItem(1, new QStandardItem(QString("Winners")));
+    m_table->setHorizontalHeaderItem(2, new QStandardItem(QString("Losers")));
+    m_table->setHorizontalHeaderItem(3, new QStandardItem(QString("Amount")));
+
+
+    if(!m_currentFile->open(QIODevice::ReadOnly)) {
+        qDebug() << m_currentFile->errorString();
+        return;
+    }
+
+
+    QTextStream in(m_currentFile);
+    unsigned int row = 0;
+    while(!in.atEnd()) {
+        QString line = in.readLine();
+
+        //parse the line into separate pieces(tokens) with ";" as the delimiter
+        QStringList lineToken = line.split(";", QString::SkipEmptyParts);
+
+        // load parsed data to model accordingly
+        for (int column = 0; column < lineToken.size(); column++) {
+            QString value = lineToken.at(column);
+            QStandardItem *item = new QStandardItem(value);
+
+            //add item to the model (row, column, item)
+            m_table->setItem(row, column, item);
+        }
+
+        row++;
+    }
+    m_currentFile->close();
+
+    //The file is stored newest first, so ids count up from the bottom row.
+    //Team names are interned once here instead of being compared as strings later.
+    for(int i = 0; i < m_table->rowCount(); i++) {
+        m_table->item(i, 0)->setData(m_table->rowCount() - 1 - i, BetIdRole);
+        m_table->item(i, 1)->setData(TeamSymbols::instance().intern(m_table->item(i, 1)->text()), TeamIdRole);
+        m_table->item(i, 2)->setData(TeamSymbols::instance().intern(m_table->item(i, 2)->text()), TeamIdRole);
+    }
+    m_nextBetId = m_table->rowCount();
+
+    rebuildAnalytics();
+
+    //The view always goes through the filter, unfiltered it maps rows one to one
+    m_filter->setSourceModel(m_table);
+    ui->tableView->setModel(m_filter);
+
+    //Every loaded model needs its own connections. itemChanged and dataChanged fire together for every
+    //edit, so only itemChanged drives the recompute
+    connect(m_table, SIGNAL(itemChanged(QStandardItem*)), this, SLOT(itemEdited(QStandardItem*)));
+    connect(m_table, SIGNAL(layoutChanged()), this, SLOT(tableSorted()));
+    connect(ui->tableView->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), this, SLOT(selectionChanged()), Qt::UniqueConnection);
+
+    applyFilter();
+    updateValues();
+}
+
+void MainWindow::updateValues()
+{
+    m_selectionAggregatesDirty = true;
+    updateSelectionValues();
+    updateTeamCompletions();
+
+    if(m_pivotDialog != nullptr && m_pivotDialog->isVisible())
+        m_pivotDialog->refresh();
+
+    updateCustomValues();
+
+    if(analytics().count() == 0)
+        return;
+
+    //Total bets
+    //Bets won
+    //Bets lost
+    //Total money
+    //Money won
+    //Money lost
+    //Max won
+    //Max lost
+    //Best team
+    //Worst team
+
+    //All totals are maintained incrementally by the analytics tree
+    const RiskAnalytics::Summary& summary = analytics().summary();
+
+    int betsWon = summary.wins, betsLost = summary.count - summary.wins;
+    double maxWon = qMax(summary.maxAmount, 0.0), maxLost = qMin(summary.minAmount, 0.0);
+
+    //The tree and the chunked reduction sum in different orders, exact sums must still agree
+    Q_ASSERT(summary.sum == aggregates().total);
+
+    updateBestWorstTeams();
+    updateRiskValues();
+
+    ui->totalBetsLineEdit->setText(QString::number(summary.count));
+    ui->betsLostLineEdit->setText(QString::number(betsLost));
+    ui->betsWonLineEdit->setText(QString::number(betsWon));
+    ui->totalMoneyLineEdit->setText(m_moneyFormat.text(summary.sum));
+    ui->moneyLostLineEdit->setText(m_moneyFormat.text(summary.lostSum));
+    ui->moneyWonLineEdit->setText(m_moneyFormat.text(summary.wonSum));
+    ui->maxWonLineEdit->setText(m_moneyFormat.text(maxWon));
+    ui->maxLostLineEdit->setText(m_moneyFormat.text(maxLost));
+}
+
+void MainWindow::updateBestWorstTeams()
+{
+    const TeamIndex::Team* mostWins = aggregates().teams.mostWins();
+    const TeamIndex::Team* mostMoney = aggregates().teams.mostMoney();
+    const TeamIndex::Team* mostLosses = aggregates().teams.mostLosses();
+
+    if(mostWins != nullptr)
+        ui->bestTeamWinsLineEdit->setText(TeamSymbols::instance().name(mostWins->id) + " (" + QString::number(mostWins->wins) + ")");
+    if(mostMoney != nullptr)
+        ui->bestTeamMoneyLineEdit->setText(TeamSymbols::instance().name(mostMoney->id) + " (" + m_moneyFormat.text(mostMoney->money) + ")");
+    if(mostLosses != nullptr)
+        ui->worstTeamLossesLineEdit->setText(TeamSymbols::instance().name(mostLosses->id) + " (" + QString::number(mostLosses->losses) + ")");
+
+    updateQuantileValues();
+}
+
+void MainWindow::updateTeamCompletions()
+{
+    TeamSymbols& symbols = TeamSymbols::instance();
+
+    //Every interned name is completable, names seen in other files rank last
+    for(int id = m_teamCompletions.size(); id < symbols.count(); id++)
+        m_teamCompletions.insert(id, TeamSymbols::fold(symbols.name(id)));
+
+    //Only teams whose bet count changed walk their trie path again
+    QList<int> weighted = m_teamCompletions.weightedIds();
+    for(int i = 0; i < weighted.size(); i++) {
+        if(m_aggregates.teams.team(weighted.at(i)) == nullptr)
+            m_teamCompletions.setWeight(weighted.at(i), 0);
+    }
+
+    QList<int> ids = m_aggregates.teams.ids();
+    for(int i = 0; i < ids.size(); i++) {
+        const TeamIndex::Team* team = m_aggregates.teams.team(ids.at(i));
+        m_teamCompletions.setWeight(team->id, team->wins + team->losses);
+    }
+}
+
+void MainWindow::setupTeamCompleter(QLineEdit* lineEdit)
+{
+    //The trie does the matching and ranking, the completer only shows its result
+    QCompleter* completer = new QCompleter(m_teamSuggestions, lineEdit);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    lineEdit->setCompleter(completer);
+}
+
+void MainWindow::loadTeamAliases()
+{
+    //Aliases are stored by name, ids are only valid for this process
+    QSettings settings("dhmitry", "Betting Statistics");
+    QVariantMap aliases = settings.value("teamAliases").toMap();
+
+    TeamSymbols& symbols = TeamSymbols::instance();
+    for(QVariantMap::const_iterator it = aliases.constBegin(); it != aliases.constEnd(); ++it)
+        symbols.setAlias(symbols.intern(it.key()), symbols.intern(it.value().toString()));
+}
+
+void MainWindow::saveTeamAliases()
+{
+    QVariantMap aliases;
+
+    TeamSymbols& symbols = TeamSymbols::instance();
+    for(int id = 0; id < symbols.count(); id++) {
+        int canonical = symbols.canonical(id);
+        if(canonical != id)
+            aliases.insert(symbols.name(id), symbols.name(canonical));
+    }
+
+    QSettings settings("dhmitry", "Betting Statistics");
+    settings.setValue("teamAliases", aliases);
+}
+
+void MainWindow::rebuildSelectionAggregates()
+{
+    //Selections are made in the filtered view, so the prefix arrays follow its rows
+    QVector<double> amounts;
+    amounts.reserve(m_filter->rowCount());
+
+    for(int i = 0; i < m_filter->rowCount(); i++)
+        amounts.append(amountAt(m_filter->sourceRow(i)));
+
+    m_selectionAggregates.build(amounts);
+    m_selectionAggregatesDirty = false;
+}
+
+void MainWindow::updateSelectionValues()
+{
+    if(ui->tableView->selectionModel() == nullptr)
+        return;
+
+    if(!ui->tableView->selectionModel()->hasSelection()) {
+        ui->selectedBetsLineEdit->clear();
+        ui->selectedMoneyLineEdit->clear();
+        ui->selectedMaxMinLineEdit->clear();
+        return;
+    }
+
+    //Prefix arrays are only rebuilt once something is actually selected
+    if(m_selectionAggregatesDirty)
+        rebuildSelectionAggregates();
+
+    //Collect the selected row ranges, sorted and merged so overlapping ranges are not counted twice
+    QList<QPair<int, int> > ranges;
+    foreach(const QItemSelectionRange& range, ui->tableView->selectionModel()->selection())
+        ranges.append(qMakePair(range.top(), range.bottom()));
+
+    std::sort(ranges.begin(), ranges.end());
+
+    RangeAggregates::Result result;
+    int first = -1, last = -2;
+    for(int i = 0; i < ranges.size(); i++) {
+        if(ranges.at(i).first <= last + 1) {
+            last = qMax(last, ranges.at(i).second);
+            continue;
+        }
+
+        result.merge(m_selectionAggregates.query(first, last));
+        first = ranges.at(i).first;
+        last = ranges.at(i).second;
+    }
+    result.merge(m_selectionAggregates.query(first, last));
+
+    if(result.count == 0) {
+        ui->selectedBetsLineEdit->clear();
+        ui->selectedMoneyLineEdit->clear();
+        ui->selectedMaxMinLineEdit->clear();
+        return;
+    }
+
+    ui->selectedBetsLineEdit->setText(QString::number(result.count) + " (" + QString::number(result.won) + "/" + QString::number(result.lost) + ")");
+    ui->selectedMoneyLineEdit->setText(m_moneyFormat.text(result.sum));
+    ui->selectedMaxMinLineEdit->setText(m_moneyFormat.text(result.max) + " / " + m_moneyFormat.text(result.min));
+}
+
+void MainWindow::rebuildAnalytics()
+{
+    //The item model can only be read on this thread, everything after the copy runs on plain columns
+    m_store.clear(m_moneyFormat.isFixed());
+    m_store.reserve(m_table->rowCount());
+
+    for(int i = 0; i < m_table->rowCount(); i++)
+        appendBet(m_store, i);
+
+    computeAnalytics(m_store, m_aggregates, m_riskAnalytics);
+    m_betIndex.build(m_store);
+    m_rollup.build(m_store);
+
+    //The store follows the table rows, which gives the id to row map for free
+    m_betRows.fill(-1, m_nextBetId);
+    for(int i = 0; i < m_store.size(); i++)
+        m_betRows[m_store.ids().at(i)] = i;
+    m_betRowsDirty = false;
+}
+
+void MainWindow::applyFilter()
+{
+    QString team = ui->filterTeamLineEdit->text().trimmed();
+    bool byDate = ui->filterDatesCheckBox->isChecked();
+
+    if(team.isEmpty() && !byDate)
+        m_filter->clearFilter();
+    else {
+        //Both indexes answer with bet ids, sorted so they can be intersected
+        QVector<int> ids;
+        if(!team.isEmpty()) {
+            TeamSymbols& symbols = TeamSymbols::instance();
+            ids = m_betIndex.bets(symbols.canonical(symbols.find(team)));
+        }
+
+        if(byDate) {
+            QVector<int> dated = m_riskAnalytics.ids(ui->filterFromDateEdit->date().toJulianDay(), ui->filterToDateEdit->date().toJulianDay());
+            std::sort(dated.begin(), dated.end());
+            ids = team.isEmpty() ? dated : BetIndex::intersect(ids, dated);
+        }
+
+        if(m_betRowsDirty)
+            rebuildBetRows();
+
+        //Ascending rows keep whatever order the table is sorted in
+        QVector<int> rows;
+        rows.reserve(ids.size());
+        for(int i = 0; i < ids.size(); i++)
+            rows.append(m_betRows.at(ids.at(i)));
+        std::sort(rows.begin(), rows.end());
+
+        m_filter->setRows(rows);
+    }
+
+    m_selectionAggregatesDirty = true;
+
+    if(followsFilter())
+        rebuildFilteredAnalytics();
+}
+
+void MainWindow::rebuildBetRows()
+{
+    m_betRows.fill(-1, m_nextBetId);
+    for(int i = 0; i < m_table->rowCount(); i++)
+        m_betRows[m_table->item(i, 0)->data(BetIdRole).toInt()] = i;
+
+    m_betRowsDirty = false;
+}
+
+void MainWindow::rebuildFilteredAnalytics()
+{
+    m_filteredStore.clear(m_moneyFormat.isFixed());
+    m_filteredStore.reserve(m_filter->rowCount());
+
+    for(int i = 0; i < m_filter->rowCount(); i++)
+        appendBet(m_filteredStore, m_filter->sourceRow(i));
+
+    computeAnalytics(m_filteredStore, m_filteredAggregates, m_filteredAnalytics);
+}
+
+void MainWindow::compileCustomExpressions(QStringList* errors)
+{
+    m_customColumnNames.clear();
+    m_customColumns.clear();
+    m_customMetricNames.clear();
+    m_customMetrics.clear();
+    m_customSymbolsRevision = TeamSymbols::instance().revision();
+
+    //"name = expression", a line without a name is its own name
+    QRegularExpression definition("^\\s*([^=!<>]+?)\\s*=(?!=)\\s*(.+)$");
+
+    for(int i = 0; i < m_customDefinitions.size(); i++) {
+        QString line = m_customDefinitions.at(i).trimmed();
+        if(line.isEmpty())
+            continue;
+
+        QRegularExpressionMatch match = definition.match(line);
+        QString name = match.hasMatch() ? match.captured(1) : line;
+        QString text = match.hasMatch() ? match.captured(2) : line;
+
+        QString error;
+        Expression expression = Expression::compile(text, &error);
+
+        if(!expression.isValid()) {
+            if(errors != nullptr)
+                errors->append(name + ": " + error);
+            continue;
+        }
+
+        if(expression.isMetric()) {
+            m_customMetricNames.append(name);
+            m_customMetrics.append(expression);
+        }
+        else {
+            m_customColumnNames.append(name);
+            m_customColumns.append(expression);
+        }
+    }
+
+    //Changing the columns resets the view, so only do it when they actually change
+    if(m_filter->extraColumns() != m_customColumnNames)
+        m_filter->setExtraColumns(m_customColumnNames, BetIdRole);
+}
+
+void MainWindow::updateCustomValues()
+{
+    if(m_customColumns.isEmpty() && m_customMetrics.isEmpty()) {
+        ui->customMetricsLineEdit->clear();
+        return;
+    }
+
+    //Team names in expressions resolve to ids at compile time, new teams and aliases need a recompile
+    if(TeamSymbols::instance().revision() != m_customSymbolsRevision)
+        compileCustomExpressions();
+
+    //Column values are kept by bet id, so sorting and filtering the view does not invalidate them
+    QVector<QVector<double> > columns;
+    QVector<bool> amounts;
+    for(int c = 0; c < m_customColumns.size(); c++) {
+        QVector<double> values = m_customColumns.at(c).evaluate(m_store, m_moneyFormat.scale());
+        QVector<double> byId(m_nextBetId, qQNaN());
+
+        for(int i = 0; i < m_store.size(); i++)
+            byId[m_store.ids().at(i)] = values.at(i);
+
+        columns.append(byId);
+        amounts.append(m_customColumns.at(c).isAmount());
+    }
+    m_filter->setExtraValues(columns, amounts, m_moneyFormat);
+
+    const BetStore& store = followsFilter() ? m_filteredStore : m_store;
+
+    QStringList metrics;
+    for(int i = 0; i < m_customMetrics.size(); i++) {
+        double value = m_customMetrics.at(i).evaluateMetric(store, m_moneyFormat.scale());
+        metrics.append(m_customMetricNames.at(i) + ": " + (m_customMetrics.at(i).isAmount() ? m_moneyFormat.moneyText(value) : QString::number(value)));
+    }
+
+    ui->customMetricsLineEdit->setText(metrics.join("   "));
+}
+
+bool MainWindow::followsFilter() const
+{
+    return ui->followFilterCheckBox->isChecked() && m_filter->isFiltered();
+}
+
+const RiskAnalytics& MainWindow::analytics() const
+{
+    return followsFilter() ? m_filteredAnalytics : m_riskAnalytics;
+}
+
+const BetAggregates& MainWindow::aggregates() const
+{
+    return followsFilter() ? m_filteredAggregates : m_aggregates;
+}
+
+void MainWindow::updateRiskValues()
+{
+    const RiskAnalytics::Summary& summary = analytics().summary();
+    RiskAnalytics::Summary rolling = analytics().latest(RollingWindow);
+
+    ui->maxDrawdownLineEdit->setText(m_moneyFormat.text(summary.maxDrawdown));
+    ui->winStreakLineEdit->setText(QString::number(summary.winStreak));
+    ui->lossStreakLineEdit->setText(QString::number(summary.lossStreak));
+
+    if(rolling.count == 0)
+        ui->rollingLineEdit->clear();
+    else
+        ui->rollingLineEdit->setText(m_moneyFormat.text(rolling.sum) + " (" + QString::number(100.0 * rolling.wins / rolling.count, 'f', 1) + "%)");
+
+    //Variance is in squared units, so it is scaled back twice
+    const RunningMoments& moments = aggregates().moments;
+    double variance = m_moneyFormat.toMoney(m_moneyFormat.toMoney(moments.variance()));
+
+    ui->standardDeviationLineEdit->setText(m_moneyFormat.text(moments.standardDeviation()) + " (" + QString::number(variance) + ")");
+    ui->sharpeLineEdit->setText(QString::number(moments.sharpeRatio()));
+    ui->expectancyLineEdit->setText(m_moneyFormat.text(moments.mean()));
+}
+
+void MainWindow::rebuildSketches()
+{
+    m_aggregates.sketch.clear();
+    m_aggregates.teams.clearSketches();
+
+    //Straight from the store's columns, the table text is not parsed again
+    const QVector<int>& winners = m_store.winners();
+    const QVector<int>& losers = m_store.losers();
+    for(int i = 0; i < m_store.size(); i++) {
+        double amount = m_store.amount(i);
+
+        m_aggregates.sketch.add(amount);
+        m_aggregates.teams.addToSketches(winners.at(i), losers.at(i), amount);
+    }
+}
+
+void MainWindow::updateQuantileValues()
+{
+    const QuantileSketch& sketch = aggregates().sketch;
+    if(sketch.count() == 0)
+        ui->quantilesLineEdit->clear();
+    else
+        ui->quantilesLineEdit->setText(m_moneyFormat.text(sketch.quantile(0.5)) + " / " +
+                                       m_moneyFormat.text(sketch.quantile(0.9)) + " / " +
+                                       m_moneyFormat.text(sketch.quantile(0.99)));
+
+    //Keep the team list in sync without losing the current choice
+    QStringList names = aggregates().teams.names();
+    QStringList items;
+    for(int i = 0; i < ui->quantileTeamComboBox->count(); i++)
+        items.append(ui->quantileTeamComboBox->itemText(i));
+
+    if(items != names) {
+        QString current = ui->quantileTeamComboBox->currentText();
+
+        ui->quantileTeamComboBox->blockSignals(true);
+        ui->quantileTeamComboBox->clear();
+        ui->quantileTeamComboBox->addItems(names);
+        ui->quantileTeamComboBox->setCurrentIndex(qMax(0, names.indexOf(current)));
+        ui->quantileTeamComboBox->blockSignals(false);
+    }
+
+    const TeamIndex::Team* team = aggregates().teams.team(ui->quantileTeamComboBox->currentText());
+    if(team == nullptr || team->amounts.count() == 0)
+        ui->teamQuantilesLineEdit->clear();
+    else
+        ui->teamQuantilesLineEdit->setText(m_moneyFormat.text(team->amounts.quantile(0.5)) + " / " +
+                                           m_moneyFormat.text(team->amounts.quantile(0.9)) + " / " +
+                                           m_moneyFormat.text(team->amounts.quantile(0.99)));
+}
+
+void MainWindow::appendBet(BetStore& store, int row) const
+{
+    RiskAnalytics::Key key = betKey(row);
+    if(store.isFixed())
+        store.appendUnits(key.day, key.id, teamAt(row, 1), teamAt(row, 2), m_moneyFormat.units(m_table->item(row, 3)->text()));
+    else
+        store.append(key.day, key.id, teamAt(row, 1), teamAt(row, 2), amountAt(row));
+}
+
+int MainWindow::teamAt(int row, int column) const
+{
+    return TeamSymbols::instance().canonical(m_table->item(row, column)->data(TeamIdRole).toInt());
+}
+
+double MainWindow::amountAt(int row) const
+{
+    return m_moneyFormat.parse(m_table->item(row, 3)->text());
+}
+
+RiskAnalytics::Key MainWindow::betKey(int row) const
+{
+    QStandardItem* date = m_table->item(row, 0);
+
+    RiskAnalytics::Key key;
+    key.day = QDate::fromString(date->text(), "yyyy.MM.dd").toJulianDay();
+    key.id = date->data(BetIdRole).toInt();
+
+    return key;
+}
+
+void MainWindow::setupPlot()
+{
+    ui->plot->clearGraphs();
+
+    ui->plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    ui->plot->setPlottingHint(QCP::phShiftDrag);
+
+    ui->plot->addGraph();
+    ui->plot->graph(0)->setPen(QPen(QColor(30, 144, 255)));
+
+    //Simulated bands sit on their own layer under the real curve
+    if(ui->plot->layer("bands") == nullptr)
+        ui->plot->addLayer("bands", ui->plot->layer("main"), QCustomPlot::limBelow);
+
+    m_bandHigh = ui->plot->addGraph();
+    m_bandLow = ui->plot->addGraph();
+    m_bandMedian = ui->plot->addGraph();
+
+    m_bandHigh->setLayer("bands");
+    m_bandLow->setLayer("bands");
+    m_bandMedian->setLayer("bands");
+
+    m_bandHigh->setPen(QPen(QColor(30, 144, 255, 60)));
+    m_bandLow->setPen(QPen(QColor(30, 144, 255, 60)));
+    m_bandHigh->setBrush(QColor(30, 144, 255, 30));
+    m_bandHigh->setChannelFillGraph(m_bandLow);
+    m_bandMedian->setPen(QPen(QColor(30, 144, 255, 120), 1, Qt::DashLine));
+
+    //Bets are keyed by their date, ticks fall on days, weeks, months or years depending on the zoom
+    ui->plot->xAxis->setVisible(true);
+    ui->plot->xAxis->setTickLabelType(QCPAxis::ltDateTime);
+    ui->plot->xAxis->setDateTimeSpec(Qt::UTC);
+    ui->plot->xAxis->setDateTimeFormat("yyyy.MM.dd");
+    ui->plot->xAxis->setCalendarTicks(true);
+    ui->plot->xAxis->setOffset(10);
+    ui->plot->xAxis->grid()->setPen(QPen(Qt::white));
+    ui->plot->xAxis->grid()->setZeroLinePen(QPen(Qt::white));
+
+    ui->plot->yAxis->setOffset(10);
+    ui->plot->yAxis->grid()->setPen(QPen(Qt::white));
+
+    ui->plot->xAxis2->setVisible(false);
+    ui->plot->xAxis2->setOffset(10);
+    ui->plot->xAxis2->setTicks(false);
+
+    ui->plot->yAxis2->setVisible(true);
+    ui->plot->yAxis2->setOffset(10);
+    ui->plot->yAxis2->setTicks(false);
+
+    updatePlotData();
+}
+
+void MainWindow::updatePlotData()
+{
+    QVector<double> y;
+    y.push_back(0);
+
+    ExactSum total;
+    QVector<double> amounts;
+    QVector<int> days;
+
+    //Either every bet or, when statistics follow the filter, the filtered ones
+    bool filtered = followsFilter();
+    int count = filtered ? m_filter->rowCount() : m_table->rowCount();
+    amounts.reserve(count);
+    days.reserve(count);
+
+    //The table can be sorted by any column, the curve always runs in date order
+    QVector<QPair<RiskAnalytics::Key, int> > bets;
+    bets.reserve(count);
+    for(int i = 0; i < count; i++) {
+        int row = filtered ? m_filter->sourceRow(i) : i;
+        bets.append(qMakePair(betKey(row), row));
+    }
+    std::sort(bets.begin(), bets.end(), [](const QPair<RiskAnalytics::Key, int>& a, const QPair<RiskAnalytics::Key, int>& b) {
+        return a.first < b.first;
+    });
+
+    for(int i = 0; i < bets.size(); i++) {
+        days.append(bets.at(i).first.day);
+
+        amounts.append(amountAt(bets.at(i).second));
+        total.add(amounts.last());
+        y.push_back(m_moneyFormat.toMoney(total.toDouble()));
+    }
+
+    //Keys are UTC seconds, the bets of one day are spread evenly over it.
+    //The curve starts at the midnight before the first bet.
+    const qint64 epochDay = QDate(1970, 1, 1).toJulianDay();
+    const double daySeconds = 86400;
+    int firstDay = days.isEmpty() ? QDate::currentDate().toJulianDay() : days.first();
+
+    m_plotKeys.clear();
+    m_plotKeys.reserve(count + 1);
+    m_plotKeys.push_back((firstDay - epochDay) * daySeconds);
+
+    for(int first = 0; first < days.size(); ) {
+        int last = first;
+        while(last + 1 < days.size() && days.at(last + 1) == days.at(first))
+            last++;
+
+        double midnight = (days.at(first) - epochDay) * daySeconds;
+        for(int i = first; i <= last; i++)
+            m_plotKeys.push_back(midnight + daySeconds * (i - first + 1) / (last - first + 2));
+
+        first = last + 1;
+    }
+
+    ui->plot->graph(0)->setData(m_plotKeys, y);
+
+    //Only a different history is worth resimulating, plain refreshes keep the bands
+    if(!ui->actionLuck_bands->isChecked()) {
+        m_simulation->cancel();
+        m_simulatedAmounts.clear();
+    }
+    else if(amounts != m_simulatedAmounts) {
+        m_simulatedAmounts = amounts;
+        m_simulation->start(amounts);
+    }
+    setLuckBandData();
+
+    ui->plot->xAxis->setRange(m_plotKeys.first(), qMax(m_plotKeys.last(), m_plotKeys.first() + daySeconds));
+    ui->plot->yAxis->setRange(ui->moneyLostLineEdit->text().toDouble(), ui->moneyWonLineEdit->text().toDouble());
+
+
+    ui->plot->replot();
+}
+
+void MainWindow::setLuckBandData()
+{
+    if(m_bandHigh == nullptr)
+        return;
+
+    const BankrollSimulation::Bands& bands = m_simulation->bands();
+    QVector<double> keys, low, median, high;
+
+    //The simulation runs in the raw units of the amounts, like the totals above.
+    //Its keys count bets, the plot keys turn them into the date of that bet.
+    if(ui->actionLuck_bands->isChecked()) {
+        for(int i = 0; i < bands.median.size(); i++) {
+            keys.append(m_plotKeys.value(int(bands.keys.at(i)), m_plotKeys.isEmpty() ? 0 : m_plotKeys.last()));
+            low.append(m_moneyFormat.toMoney(bands.low.at(i)));
+            median.append(m_moneyFormat.toMoney(bands.median.at(i)));
+            high.append(m_moneyFormat.toMoney(bands.high.at(i)));
+        }
+    }
+
+    m_bandLow->setData(keys, low);
+    m_bandMedian->setData(keys, median);
+    m_bandHigh->setData(keys, high);
+}
+
+void MainWindow::offerToSave()
+{
+    int result = QMessageBox::question(this, "Betting Statistics", "Changes unsaved. Would you like to save them?",
+                                       QMessageBox::Cancel | QMessageBox::No | QMessageBox::Yes,
+                                       QMessageBox::Yes);
+
+    if(result == QMessageBox::Yes)
+        save();
+    else
+        return;
+}
+
+QString MainWindow::getLastFilePath() const
+{
+    QFile file("lastfile.txt");
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << file.errorString();
+        return "";
+    }
+
+    QTextStream in(&file);
+    QString path = in.readLine();
+
+    file.close();
+
+    return path;
+}
+
+void MainWindow::enableUi()
+{
+    ui->dateEdit->setEnabled(true);
+    ui->amountLineEdit->setEnabled(true);
+    ui->winnersLineEdit->setEnabled(true);
+    ui->losersLineEdit->setEnabled(true);
+    ui->addButton->setEnabled(true);
+    ui->removeButton->setEnabled(true);
+    ui->filterTeamLineEdit->setEnabled(true);
+    ui->filterDatesCheckBox->setEnabled(true);
+    ui->filterFromDateEdit->setEnabled(true);
+    ui->filterToDateEdit->setEnabled(true);
+    ui->followFilterCheckBox->setEnabled(true);
+
+    ui->plot->setEnabled(true);
+}
+
+void MainWindow::disableUi()
+{
+    ui->dateEdit->setEnabled(false);
+    ui->amountLineEdit->setEnabled(false);
+    ui->winnersLineEdit->setEnabled(false);
+    ui->losersLineEdit->setEnabled(false);
+    ui->addButton->setEnabled(false);
+    ui->removeButton->setEnabled(false);
+    ui->filterTeamLineEdit->setEnabled(false);
+    ui->filterDatesCheckBox->setEnabled(false);
+    ui->filterFromDateEdit->setEnabled(false);
+    ui->filterToDateEdit->setEnabled(false);
+    ui->followFilterCheckBox->setEnabled(false);
+
+    m_simulation->cancel();
+    m_simulatedAmounts.clear();
+
+    ui->plot->clearGraphs();
+    m_bandHigh = m_bandLow = m_bandMedian = nullptr;
+    ui->plot->replot();
+    ui->plot->setEnabled(false);
+}
+
+//// Signals & slots /////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MainWindow::itemEdited(QStandardItem* item)
+{
+    int row = item->row();
+
+    if(item->column() == 1 || item->column() == 2) {
+        //Refresh the interned id of an edited team name; the role is not shown, so no signals are needed
+        int id = TeamSymbols::instance().intern(item->text());
+        if(item->data(TeamIdRole).toInt() != id) {
+            m_table->blockSignals(true);
+            item->setData(id, TeamIdRole);
+            m_table->blockSignals(false);
+        }
+    }
+
+    //The store still holds the bet as it was before the edit, which is what the engines have to forget
+    RiskAnalytics::Key key = betKey(row);
+    int index = m_store.indexOf(key.id);
+    if(index < 0) {
+        rebuildAnalytics();
+    }
+    else {
+        RiskAnalytics::Key old;
+        old.day = m_store.days().at(index);
+        old.id = key.id;
+        int winners = m_store.winners().at(index);
+        int losers = m_store.losers().at(index);
+        double amount = m_store.amount(index);
+
+        m_riskAnalytics.remove(old);
+        m_aggregates.remove(winners, losers, amount);
+        m_betIndex.remove(old.id, winners, losers);
+        m_rollup.remove(old.day, winners, losers, amount);
+        m_store.remove(old.id);
+
+        //An edited date can move a bet anywhere in the history, the engines place it by key
+        amount = amountAt(row);
+        m_riskAnalytics.insert(key, amount);
+        m_aggregates.add(teamAt(row, 1), teamAt(row, 2), amount);
+        m_betIndex.add(key.id, teamAt(row, 1), teamAt(row, 2));
+        m_rollup.add(key.day, teamAt(row, 1), teamAt(row, 2), amount);
+        appendBet(m_store, row);
+
+        if(m_aggregates.teams.sketchesStale())
+            rebuildSketches();
+    }
+    m_betRowsDirty = true;
+
+    //Sorting refilters through tableSorted, the edit may have moved the bet in or out of the filter
+    ui->tableView->sortByColumn(0, Qt::DescendingOrder);
+
+    m_saved = false;
+    updateValues();
+    updatePlotData();
+}
+
+void MainWindow::tableSorted()
+{
+    //Row order changed, so the prefix arrays and the id to row map have to follow the new order
+    m_selectionAggregatesDirty = true;
+    m_betRowsDirty = true;
+
+    if(m_filter->isFiltered())
+        applyFilter();
+
+    updateSelectionValues();
+}
+
+void MainWindow::selectionChanged()
+{
+    updateSelectionValues();
+}
+
+void MainWindow::quantileTeamChanged()
+{
+    updateQuantileValues();
+}
+
+void MainWindow::filterChanged()
+{
+    applyFilter();
+    updateValues();
+    updatePlotData();
+}
+
+void MainWindow::teamTextEdited(const QString& text)
+{
+    QLineEdit* lineEdit = qobject_cast<QLineEdit*>(sender());
+    if(lineEdit == nullptr)
+        return;
+
+    QStringList suggestions;
+    if(!text.trimmed().isEmpty()) {
+        QVector<int> ids = m_teamCompletions.complete(TeamSymbols::fold(text.trimmed()));
+        for(int i = 0; i < ids.size(); i++)
+            suggestions.append(TeamSymbols::instance().name(ids.at(i)));
+    }
+
+    m_teamSuggestions->setStringList(suggestions);
+
+    if(suggestions.isEmpty())
+        lineEdit->completer()->popup()->hide();
+    else
+        lineEdit->completer()->complete();
+}
+
+void MainWindow::newFile()
+{
+    if(!m_saved) offerToSave();
+
+    QString path = QFileDialog::getSaveFileName(this, "New File", "./statistics.csv", "*.csv");
+    m_currentFile = new QFile(path);
+
+
+    if(!m_currentFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << m_currentFile->errorString();
+        return;
+    }
+
+    QTextStream out(m_currentFile);
+        out << ";";
+
+    m_currentFile->close();
+
+    enableUi();
+    loadTable();
+}
+
+void MainWindow::open()
+{
+    if(!m_saved) offerToSave();
+
+    QString selectedFilter = "CSV (*.csv)";
+    QString path = QFileDialog::getOpenFileName(this, "Open File", "./", "CSV (*.csv)", &selectedFilter);
+
+    m_currentFile = new QFile(path);
+
+    if(m_currentFile->fileName() == "") {
+        ui->tableView->setModel(nullptr);
+        disableUi();
+    }
+    else {
+        enableUi();
+        loadTable();
+        setupPlot();
+    }
+
+}
+
+void MainWindow::openArchive()
+{
+    QString selectedFilter = "CSV (*.csv)";
+    QString path = QFileDialog::getOpenFileName(this, "Open Archive", "./", "CSV (*.csv)", &selectedFilter);
+
+    if(path == "")
+        return;
+
+    //Archives never go through the bet table, they are paged from disk within the memory cap
+    QSettings settings("dhmitry", "Betting Statistics");
+    qint64 cacheLimit = qint64(settings.value("archiveCacheMegabytes", 64).toInt()) << 20;
+
+    ArchiveDialog* dialog = new ArchiveDialog(path, cacheLimit, m_moneyFormat, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    if(!dialog->isOpen()) {
+        QMessageBox::warning(this, "Betting Statistics", "Could not open the archive:\n" + dialog->errorString(), QMessageBox::Ok);
+        delete dialog;
+        return;
+    }
+
+    dialog->show();
+}
+
+void MainWindow::save()
+{
+    if(m_currentFile->fileName() == "") {
+        newFile();
+        return;
+    }
+
+    if(!m_currentFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << m_currentFile->errorString();
+        return;
+    }
+
+    QTextStream out(m_currentFile);
+    for(int row = 0; row < m_table->rowCount(); row++) {
+        for(int col = 0; col < 4; col++) {
+            out << m_table->item(row, col)->text() << ";";
+        }
+        out << "\n";
+    }
+
+    m_currentFile->close();
+
+    m_saved = true;
+}
+
+void MainWindow::saveAs()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Save File", "./statistics.csv", "*.csv");
+
+    if(path != "") {
+        m_currentFile = new QFile(path);
+        save();
+    }
+}
+
+void MainWindow::close()
+{
+    //Save last file path
+    QFile file("lastfile.txt");
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+
+    QTextStream out(&file);
+    out << m_currentFile->fileName();
+
+    file.close();
+
+    //If changes saved, exit the application
+    if(m_saved) {
+        QApplication::exit();
+        return;
+    }
+
+    //If changes unsaved, ask if user would like to save them
+    int result = QMessageBox::question(this, "Betting Statistics", "Changes unsaved. Would you like to save them?",
+                                       QMessageBox::Cancel | QMessageBox::No | QMessageBox::Yes,
+                                       QMessageBox::Yes);
+
+    if(result == QMessageBox::Cancel)
+        return;
+    else if(result == QMessageBox::No)
+        QApplication::exit();
+    else if(result == QMessageBox::Yes) {
+        save();
+        QApplication::exit();
+    }
+}
+
+void MainWindow::about()
+{
+    QMessageBox::information(this, "About", "This program was made by dhmitry\nVersion 1.0.3", QMessageBox::Ok);
+}
+
+void MainWindow::aboutQt()
+{
+    qApp->aboutQt();
+}
+
+void MainWindow::fixedPointToggled(bool checked)
+{
+    int decimals = -1;
+
+    if(checked) {
+        bool ok;
+        decimals = QInputDialog::getInt(this, "Betting Statistics", "Decimal places of fixed-point amounts:",
+                                        qMax(m_moneyFormat.decimals(), 2), 0, 9, 1, &ok);
+
+        if(!ok) {
+            ui->actionFixed_point_amounts->blockSignals(true);
+            ui->actionFixed_point_amounts->setChecked(m_moneyFormat.isFixed());
+            ui->actionFixed_point_amounts->blockSignals(false);
+            return;
+        }
+    }
+
+    m_moneyFormat = MoneyFormat(decimals);
+
+    QSettings settings("dhmitry", "Betting Statistics");
+    settings.setValue("fixedPointDecimals", decimals);
+
+    //Every statistic is kept in the units of the current format
+    rebuildAnalytics();
+    applyFilter();
+    updateValues();
+    updatePlotData();
+}
+
+void MainWindow::archiveMemoryCap()
+{
+    QSettings settings("dhmitry", "Betting Statistics");
+
+    bool ok;
+    int megabytes = QInputDialog::getInt(this, "Betting Statistics", "Memory cap of the archive block cache (MB):",
+                                         settings.value("archiveCacheMegabytes", 64).toInt(), 1, 65536, 16, &ok);
+    if(ok)
+        settings.setValue("archiveCacheMegabytes", megabytes);
+}
+
+void MainWindow::luckBandsToggled(bool checked)
+{
+    QSettings settings("dhmitry", "Betting Statistics");
+    settings.setValue("luckBands", checked);
+
+    //Nothing is plotted while no file is open
+    if(ui->plot->graphCount() > 0)
+        updatePlotData();
+}
+
+void MainWindow::updateLuckBands()
+{
+    setLuckBandData();
+    ui->plot->replot();
+}
+
+void MainWindow::mergeTeamAliases()
+{
+    TeamSymbols& symbols = TeamSymbols::instance();
+
+    //Only teams that are still their own canonical id take part
+    QVector<int> ids;
+    QVector<QString> names;
+    for(int id = 0; id < symbols.count(); id++) {
+        if(symbols.canonical(id) == id) {
+            ids.append(id);
+            names.append(TeamSymbols::fold(symbols.name(id)));
+        }
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QVector<TeamMatcher::Match> matches = TeamMatcher().matches(names);
+    QApplication::restoreOverrideCursor();
+
+    if(matches.isEmpty()) {
+        QMessageBox::information(this, "Betting Statistics", "No likely team aliases found.", QMessageBox::Ok);
+        return;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Merge team aliases");
+
+    QListWidget* list = new QListWidget(&dialog);
+    QVector<QPair<int, int> > merges;
+
+    for(int i = 0; i < matches.size(); i++) {
+        int first = ids.at(matches.at(i).first), second = ids.at(matches.at(i).second);
+
+        //The team with more bets keeps its name, otherwise the longer spelling
+        const TeamIndex::Team* firstTeam = m_aggregates.teams.team(first);
+        const TeamIndex::Team* secondTeam = m_aggregates.teams.team(second);
+        int firstBets = firstTeam == nullptr ? 0 : firstTeam->wins + firstTeam->losses;
+        int secondBets = secondTeam == nullptr ? 0 : secondTeam->wins + secondTeam->losses;
+
+        bool keepFirst = firstBets != secondBets ? firstBets > secondBets : symbols.name(first).size() >= symbols.name(second).size();
+        int canonical = keepFirst ? first : second, alias = keepFirst ? second : first;
+
+        QListWidgetItem* item = new QListWidgetItem(symbols.name(alias) + " -> " + symbols.name(canonical) +
+                                                    " (" + QString::number(qRound(matches.at(i).score * 100)) + "%)", list);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+        merges.append(qMakePair(alias, canonical));
+    }
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    QVBoxLayout* layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel("Check the spellings that name the same team:", &dialog));
+    layout->addWidget(list);
+    layout->addWidget(buttons);
+    dialog.resize(480, 360);
+
+    if(dialog.exec() != QDialog::Accepted)
+        return;
+
+    bool merged = false;
+    for(int i = 0; i < list->count(); i++) {
+        if(list->item(i)->checkState() == Qt::Checked) {
+            symbols.setAlias(merges.at(i).first, merges.at(i).second);
+            merged = true;
+        }
+    }
+
+    if(!merged)
+        return;
+
+    saveTeamAliases();
+
+    //Team aggregates are keyed by canonical id and have to be regrouped
+    rebuildAnalytics();
+    applyFilter();
+    updateValues();
+}
+
+void MainWindow::clearTeamAliases()
+{
+    TeamSymbols::instance().clearAliases();
+    saveTeamAliases();
+
+    rebuildAnalytics();
+    applyFilter();
+    updateValues();
+}
+
+void MainWindow::showPivotTable()
+{
+    //Non-modal, so it stays open and follows edits of the table
+    if(m_pivotDialog == nullptr)
+        m_pivotDialog = new PivotDialog(m_rollup, m_moneyFormat, this);
+    else
+        m_pivotDialog->refresh();
+
+    m_pivotDialog->show();
+    m_pivotDialog->raise();
+    m_pivotDialog->activateWindow();
+}
+
+void MainWindow::editCustomExpressions()
+{
+    bool ok;
+    QString text = QInputDialog::getMultiLineText(this, "Custom columns and metrics",
+                                                  "One per line as name = expression. Expressions using sum(), avg(), min(), max() or count()\n"
+                                                  "are metrics, the others are columns. For example:\n"
+                                                  "  double = amount * 2\n"
+                                                  "  NiP last month = count(winners == \"NiP\" && day > today - 30)",
+                                                  m_customDefinitions.join("\n"), &ok);
+    if(!ok)
+        return;
+
+    m_customDefinitions = text.split('\n', QString::SkipEmptyParts);
+
+    QSettings settings("dhmitry", "Betting Statistics");
+    settings.setValue("customExpressions", m_customDefinitions);
+
+    QStringList errors;
+    compileCustomExpressions(&errors);
+
+    if(!errors.isEmpty())
+        QMessageBox::warning(this, "Betting Statistics", "Some expressions were skipped:\n" + errors.join("\n"), QMessageBox::Ok);
+
+    updateValues();
+}
+
+void MainWindow::add()
+{    
+    //Check if all information is entered
+    if(ui->dateEdit->date().toString("yyyy.MM.dd") == "" || ui->winnersLineEdit->text() == "" ||
+       ui->losersLineEdit->text() == "" || ui->amountLineEdit->text() == "") {
+        QMessageBox::information(this, "Betting Statistics", "You need to enter all information!");
+
+        return;
+    }
+
+    //Fixed-point amounts are stored in canonical form so the file reads back to the same units
+    QString amountText = ui->amountLineEdit->text();
+    if(m_moneyFormat.isFixed()) {
+        bool ok;
+        qint64 units = m_moneyFormat.units(amountText, &ok);
+        if(!ok) {
+            QMessageBox::information(this, "Betting Statistics", "The amount is too large for fixed-point mode!");
+
+            return;
+        }
+        amountText = m_moneyFormat.format(units);
+    }
+
+    //Add new row
+    QStandardItem* date = new QStandardItem(ui->dateEdit->date().toString("yyyy.MM.dd"));
+    QStandardItem* winners = new QStandardItem(ui->winnersLineEdit->text());
+    QStandardItem* losers = new QStandardItem(ui->losersLineEdit->text());
+    QStandardItem* amount = new QStandardItem(amountText);
+
+    date->setData(m_nextBetId++, BetIdRole);
+    winners->setData(TeamSymbols::instance().intern(winners->text()), TeamIdRole);
+    losers->setData(TeamSymbols::instance().intern(losers->text()), TeamIdRole);
+
+    QList<QStandardItem*> newRow;
+    newRow.append(date);
+    newRow.append(winners);
+    newRow.append(losers);
+    newRow.append(amount);
+
+    //Inserted on top so the stable sort keeps it as the newest bet of its day
+    m_table->insertRow(0, newRow);
+
+    RiskAnalytics::Key key;
+    key.day = ui->dateEdit->date().toJulianDay();
+    key.id = date->data(BetIdRole).toInt();
+    m_riskAnalytics.insert(key, m_moneyFormat.parse(amount->text()));
+    m_aggregates.add(teamAt(0, 1), teamAt(0, 2), m_moneyFormat.parse(amount->text()));
+    m_betIndex.add(key.id, teamAt(0, 1), teamAt(0, 2));
+    m_rollup.add(key.day, teamAt(0, 1), teamAt(0, 2), m_moneyFormat.parse(amount->text()));
+    appendBet(m_store, 0);
+    m_betRowsDirty = true;
+
+    //Reset line edits
+    ui->winnersLineEdit->clear();
+    ui->losersLineEdit->clear();
+    ui->amountLineEdit->clear();
+
+
+    ui->tableView->sortByColumn(0, Qt::DescendingOrder);
+
+    m_saved = false;
+    updateValues();
+    updatePlotData();
+}
+
+void MainWindow::remove()
+{
+    QModelIndexList selection = ui->tableView->selectionModel()->selectedRows();
+
+    if(selection.count() == 0)
+        return;
+
+    //The selection is in filtered rows, removal works on table rows
+    QVector<int> rows;
+    for(int i = 0; i < selection.size(); i++)
+        rows.append(m_filter->sourceRow(selection.at(i).row()));
+
+    //Remove from the bottom up so the remaining indexes stay valid
+    std::sort(rows.begin(), rows.end());
+
+    while(!rows.isEmpty()) {
+        int row = rows.last();
+        double amount = amountAt(row);
+        RiskAnalytics::Key key = betKey(row);
+
+        m_riskAnalytics.remove(key);
+        m_aggregates.remove(teamAt(row, 1), teamAt(row, 2), amount);
+        m_betIndex.remove(key.id, teamAt(row, 1), teamAt(row, 2));
+        m_rollup.remove(key.day, teamAt(row, 1), teamAt(row, 2), amount);
+        m_store.remove(key.id);
+
+        m_table->removeRow(row);
+        rows.removeLast();
+    }
+
+    if(m_aggregates.teams.sketchesStale())
+        rebuildSketches();
+
+    m_betRowsDirty = true;
+    applyFilter();
+
+    m_saved = false;
+    updateValues();
+    updatePlotData();
+}
+
+void MainWindow::resetGraph()
+{
+    updatePlotData();
+}
@@ -1,58 +1,144 @@
-#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-#include <QMainWindow>
-#include <QStandardItemModel>
-#include <QFile>
-
-namespace Ui {
-class MainWindow;
-}
-
-class MainWindow : public QMainWindow
-{
-    Q_OBJECT
-
-public:
-    explicit MainWindow(QWidget *parent = 0);
-    ~MainWindow();
-
-protected:
-    void closeEvent(QCloseEvent *event);
-
-private slots:
-    void tableChanged();
-
-    void newFile();
-    void open();
-    void save();
-    void saveAs();
-    void close();
-    void about();
-    void aboutQt();
-
-    void add();
-    void remove();
-    void resetGraph();
-
-private:
-    Ui::MainWindow* ui;
-    QStandardItemModel* m_table;
-    QFile* m_currentFile;
-    bool m_saved;
-
-    void loadTable();
-    void updateValues();
-    void updateBestWorstTeams();
-
-    void setupPlot();
-    void updatePlotData();
-
-    void offerToSave();
-    void enableUi();
-    void disableUi();
-
-    QString getLastFilePath() const;
-};
-
-#endif // MAINWINDOW_H
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QStandardItemModel>
+#include <QFile>
+#include <QLineEdit>
+#include <QCompleter>
+#include <QStringListModel>
+#include "qcustomplot.h"
+#include "rangeaggregates.h"
+#include "riskanalytics.h"
+#include "exactsum.h"
+#include "moneyformat.h"
+#include "teamsymbols.h"
+#include "betaggregates.h"
+#include "prefixtrie.h"
+#include "betindex.h"
+#include "betfiltermodel.h"
+#include "rollupcube.h"
+#include "pivotdialog.h"
+#include "expression.h"
+#include "bankrollsimulation.h"
+#include "archivedialog.h"
+
+namespace Ui {
+class MainWindow;
+}
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit MainWindow(QWidget *parent = 0);
+    ~MainWindow();
+
+protected:
+    void closeEvent(QCloseEvent *event);
+
+private slots:
+    void itemEdited(QStandardItem* item);
+    void tableSorted();
+    void selectionChanged();
+    void quantileTeamChanged();
+    void teamTextEdited(const QString& text);
+    void filterChanged();
+
+    void newFile();
+    void open();
+    void openArchive();
+    void save();
+    void saveAs();
+    void close();
+    void about();
+    void aboutQt();
+    void fixedPointToggled(bool checked);
+    void archiveMemoryCap();
+    void mergeTeamAliases();
+    void clearTeamAliases();
+    void showPivotTable();
+    void editCustomExpressions();
+    void luckBandsToggled(bool checked);
+    void updateLuckBands();
+
+    void add();
+    void remove();
+    void resetGraph();
+
+private:
+    Ui::MainWindow* ui;
+    QStandardItemModel* m_table;
+    QFile* m_currentFile;
+    bool m_saved;
+    MoneyFormat m_moneyFormat;
+    RangeAggregates m_selectionAggregates;
+    bool m_selectionAggregatesDirty;
+    RiskAnalytics m_riskAnalytics;
+    BetAggregates m_aggregates;
+    int m_nextBetId;
+    PrefixTrie m_teamCompletions;
+    QStringListModel* m_teamSuggestions;
+    BetFilterModel* m_filter;
+    BetIndex m_betIndex;
+    QVector<int> m_betRows;
+    bool m_betRowsDirty;
+    RiskAnalytics m_filteredAnalytics;
+    BetAggregates m_filteredAggregates;
+    RollupCube m_rollup;
+    BetStore m_store;
+    BetStore m_filteredStore;
+    QStringList m_customDefinitions;
+    QStringList m_customColumnNames;
+    QVector<Expression> m_customColumns;
+    QStringList m_customMetricNames;
+    QVector<Expression> m_customMetrics;
+    int m_customSymbolsRevision;
+    PivotDialog* m_pivotDialog;
+    BankrollSimulation* m_simulation;
+    QVector<double> m_simulatedAmounts;
+    QVector<double> m_plotKeys;
+    QCPGraph* m_bandHigh;
+    QCPGraph* m_bandLow;
+    QCPGraph* m_bandMedian;
+
+    void loadTable();
+    void updateValues();
+    void updateBestWorstTeams();
+    void rebuildSelectionAggregates();
+    void updateSelectionValues();
+    void rebuildAnalytics();
+    void applyFilter();
+    void rebuildBetRows();
+    void rebuildFilteredAnalytics();
+    void compileCustomExpressions(QStringList* errors = 0);
+    void updateCustomValues();
+    void setLuckBandData();
+    bool followsFilter() const;
+    const RiskAnalytics& analytics() const;
+    const BetAggregates& aggregates() const;
+    void updateRiskValues();
+    void rebuildSketches();
+    void updateQuantileValues();
+    void updateTeamCompletions();
+    void setupTeamCompleter(QLineEdit* lineEdit);
+    void loadTeamAliases();
+    void saveTeamAliases();
+
+    RiskAnalytics::Key betKey(int row) const;
+    double amountAt(int row) const;
+    int teamAt(int row, int column) const;
+    void appendBet(BetStore& store, int row) const;
+
+    void setupPlot();
+    void updatePlotData();
+
+    void offerToSave();
+    void enableUi();
+    void disableUi();
+
+    QString getLastFilePath() const;
+};
+
+#endif // MAINWINDOW_H
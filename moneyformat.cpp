@@ -0,0 +1,155 @@
+#include "moneyformat.h"
+#include <qmath.h>
+#include <cmath>
+
+namespace {
+
+//Largest unit count a double holds exactly (2^53), larger amounts are rejected
+const qint64 MaxUnits = Q_INT64_C(9007199254740992);
+
+}
+
+MoneyFormat::MoneyFormat(int decimals) :
+    m_decimals(qBound(-1, decimals, 9)),
+    m_scale(m_decimals > 0 ? qPow(10.0, m_decimals) : 1.0)
+{
+}
+
+double MoneyFormat::parse(const QString& text, bool* ok) const
+{
+    if(!isFixed())
+        return text.toDouble(ok);
+
+    return double(units(text, ok));
+}
+
+qint64 MoneyFormat::units(const QString& text, bool* ok) const
+{
+    qint64 units;
+    if(parseUnits(text, units)) {
+        if(ok) *ok = true;
+        return units;
+    }
+
+    //Too many digits for exact parsing, fall back to rounding the floating point value
+    bool valid;
+    double value = text.toDouble(&valid) * m_scale;
+    valid = valid && qAbs(value) <= double(MaxUnits);
+    if(ok) *ok = valid;
+    return valid ? qRound64(value) : 0;
+}
+
+QString MoneyFormat::format(qint64 units) const
+{
+    if(!isFixed())
+        return QString::number(double(units));
+
+    QString sign = units < 0 ? "-" : "";
+    quint64 magnitude = units < 0 ? quint64(0) - quint64(units) : quint64(units);
+
+    quint64 divisor = 1;
+    for(int i = 0; i < m_decimals; i++)
+        divisor *= 10;
+
+    QString text = sign + QString::number(magnitude / divisor);
+    if(m_decimals > 0)
+        text += "." + QString::number(magnitude % divisor).rightJustified(m_decimals, '0');
+
+    return text;
+}
+
+QString MoneyFormat::text(double units) const
+{
+    //Whole unit counts (sums, extremes, quantiles) are printed exactly
+    if(isFixed() && units == std::floor(units) && qAbs(units) < 9e15)
+        return format(qint64(units));
+
+    return QString::number(toMoney(units));
+}
+
+QString MoneyFormat::text(const ExactSum& units) const
+{
+    //Sums of integer units are integers, so the integer part is the exact total
+    if(isFixed())
+        return format(units.integerPart());
+
+    return QString::number(units.toDouble());
+}
+
+bool MoneyFormat::parseUnits(const QString& text, qint64& units) const
+{
+    //Accepts the same shape as the amount validator: [-+]digits[.digits][e[-+]digits]
+    QString string = text.trimmed();
+    int i = 0;
+
+    bool negative = false;
+    if(i < string.size() && (string.at(i) == '-' || string.at(i) == '+')) {
+        negative = string.at(i) == '-';
+        i++;
+    }
+
+    qint64 digits = 0;
+    int digitCount = 0, fractionDigits = 0;
+    bool point = false;
+    for(; i < string.size(); i++) {
+        QChar c = string.at(i);
+
+        if(c == '.' && !point) {
+            point = true;
+            continue;
+        }
+        if(!c.isDigit())
+            break;
+
+        //Leading zeros do not count towards the precision limit
+        if(digits == 0 && c == '0') {
+            if(point) fractionDigits++;
+            continue;
+        }
+        if(++digitCount > 18)
+            return false;
+
+        digits = digits * 10 + c.digitValue();
+        if(point) fractionDigits++;
+    }
+
+    int exponent = 0;
+    if(i < string.size() && (string.at(i) == 'e' || string.at(i) == 'E')) {
+        bool ok;
+        exponent = string.mid(i + 1).toInt(&ok);
+        if(!ok)
+            return false;
+        i = string.size();
+    }
+
+    if(i != string.size())
+        return false;
+
+    //units = digits * 10^shift, rounded half away from zero when shift is negative
+    int shift = exponent - fractionDigits + m_decimals;
+    if(shift >= 0) {
+        for(int j = 0; j < shift && digits != 0; j++) {
+            if(digits > MaxUnits / 10)
+                return false;
+            digits *= 10;
+        }
+    }
+    else {
+        if(shift < -18) {
+            digits = 0;
+        }
+        else {
+            qint64 divisor = 1;
+            for(int j = 0; j < -shift; j++)
+                divisor *= 10;
+
+            digits = (digits + divisor / 2) / divisor;
+        }
+    }
+
+    if(digits > MaxUnits)
+        return false;
+
+    units = negative ? -digits : digits;
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef MONEYFORMAT_H
+#define MONEYFORMAT_H
+
+#include <QString>
+#include "exactsum.h"
+
+//How Amount text is turned into numbers. By default amounts are parsed as
+//floating point. In fixed-point mode they are parsed exactly as an integer count
+//of 10^-decimals units (e.g. cents for 2 decimals), and all statistics work on
+//those integer units, so every sum is exact. Only conversion for display and
+//plotting divides by the scale again.
+class MoneyFormat
+{
+public:
+    explicit MoneyFormat(int decimals = -1);
+
+    bool isFixed() const { return m_decimals >= 0; }
+    int decimals() const { return m_decimals; }
+    double scale() const { return m_scale; }
+
+    //Amount in statistics units: money for floating point, integer units for fixed point
+    double parse(const QString& text, bool* ok = nullptr) const;
+
+    //Exact fixed-point unit count; amounts above 2^53 units set ok to false and return 0
+    qint64 units(const QString& text, bool* ok = nullptr) const;
+
+    //Canonical text of a fixed-point amount; parse(format(units)) == units
+    QString format(qint64 units) const;
+
+    double toMoney(double units) const { return units / m_scale; }
+    QString text(double units) const;
+    QString text(const ExactSum& units) const;
+
+    //Text of a value already in currency, e.g. a custom expression result
+    QString moneyText(double money) const { return text(money * m_scale); }
+
+private:
+    int m_decimals;
+    double m_scale;
+
+    bool parseUnits(const QString& text, qint64& units) const;
+};
+
+#endif // MONEYFORMAT_H
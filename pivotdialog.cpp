@@ -0,0 +1,181 @@
+#include "pivotdialog.h"
+#include "teamsymbols.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <algorithm>
+
+PivotDialog::PivotDialog(const RollupCube& cube, const MoneyFormat& format, QWidget* parent) :
+    QDialog(parent),
+    m_cube(cube),
+    m_format(format),
+    m_rows(new QComboBox(this)),
+    m_columns(new QComboBox(this)),
+    m_slice(new QComboBox(this)),
+    m_measure(new QComboBox(this)),
+    m_sliceLabel(new QLabel(this)),
+    m_table(new QTableWidget(this)),
+    m_sliceDimension(-1)
+{
+    setWindowTitle("Pivot table");
+
+    QStringList dimensions;
+    dimensions << "Team" << "Month" << "Outcome";
+
+    m_rows->addItems(dimensions);
+    m_columns->addItems(dimensions);
+    m_rows->setCurrentIndex(TeamDimension);
+    m_columns->setCurrentIndex(MonthDimension);
+
+    m_measure->addItem("Money");
+    m_measure->addItem("Bets");
+
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QHBoxLayout* controls = new QHBoxLayout;
+    controls->addWidget(new QLabel("Rows:", this));
+    controls->addWidget(m_rows);
+    controls->addWidget(new QLabel("Columns:", this));
+    controls->addWidget(m_columns);
+    controls->addWidget(m_sliceLabel);
+    controls->addWidget(m_slice);
+    controls->addWidget(new QLabel("Show:", this));
+    controls->addWidget(m_measure);
+    controls->addStretch();
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addLayout(controls);
+    layout->addWidget(m_table);
+
+    resize(640, 420);
+
+    connect(m_rows, SIGNAL(currentIndexChanged(int)), this, SLOT(rowsChanged()));
+    connect(m_columns, SIGNAL(currentIndexChanged(int)), this, SLOT(columnsChanged()));
+    connect(m_slice, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+    connect(m_measure, SIGNAL(currentIndexChanged(int)), this, SLOT(refresh()));
+
+    refresh();
+}
+
+void PivotDialog::refresh()
+{
+    int rows = m_rows->currentIndex(), columns = m_columns->currentIndex(), slice = sliceDimension();
+
+    //Keep the slice choice while the cube changes underneath, a new slice dimension starts at its total
+    QVariant current = slice == m_sliceDimension ? m_slice->currentData() : QVariant();
+    m_sliceDimension = slice;
+    QList<int> sliceValues = values(slice);
+
+    m_slice->blockSignals(true);
+    m_slice->clear();
+    for(int i = 0; i < sliceValues.size(); i++)
+        m_slice->addItem(label(slice, sliceValues.at(i)), sliceValues.at(i));
+    int index = current.isValid() ? m_slice->findData(current) : -1;
+    m_slice->setCurrentIndex(index == -1 ? m_slice->count() - 1 : index);
+    m_slice->blockSignals(false);
+
+    QStringList dimensions;
+    dimensions << "Team:" << "Month:" << "Outcome:";
+    m_sliceLabel->setText(dimensions.at(slice));
+
+    QList<int> rowValues = values(rows), columnValues = values(columns);
+    bool money = m_measure->currentIndex() == 0;
+
+    QStringList rowLabels, columnLabels;
+    for(int i = 0; i < rowValues.size(); i++)
+        rowLabels.append(label(rows, rowValues.at(i)));
+    for(int i = 0; i < columnValues.size(); i++)
+        columnLabels.append(label(columns, columnValues.at(i)));
+
+    m_table->clear();
+    m_table->setRowCount(rowValues.size());
+    m_table->setColumnCount(columnValues.size());
+    m_table->setVerticalHeaderLabels(rowLabels);
+    m_table->setHorizontalHeaderLabels(columnLabels);
+
+    int coordinates[3];
+    coordinates[slice] = m_slice->currentData().toInt();
+
+    for(int r = 0; r < rowValues.size(); r++) {
+        coordinates[rows] = rowValues.at(r);
+
+        for(int c = 0; c < columnValues.size(); c++) {
+            coordinates[columns] = columnValues.at(c);
+
+            RollupCube::Cell cell = m_cube.cell(coordinates[TeamDimension], coordinates[MonthDimension], coordinates[OutcomeDimension]);
+            if(cell.count == 0)
+                continue;
+
+            QTableWidgetItem* item = new QTableWidgetItem(money ? m_format.text(cell.sum) : QString::number(cell.count));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_table->setItem(r, c, item);
+        }
+    }
+}
+
+void PivotDialog::rowsChanged()
+{
+    //Rows and columns always show two different dimensions
+    if(m_columns->currentIndex() == m_rows->currentIndex()) {
+        m_columns->blockSignals(true);
+        m_columns->setCurrentIndex((m_rows->currentIndex() + 1) % 3);
+        m_columns->blockSignals(false);
+    }
+
+    refresh();
+}
+
+void PivotDialog::columnsChanged()
+{
+    if(m_rows->currentIndex() == m_columns->currentIndex()) {
+        m_rows->blockSignals(true);
+        m_rows->setCurrentIndex((m_columns->currentIndex() + 1) % 3);
+        m_rows->blockSignals(false);
+    }
+
+    refresh();
+}
+
+int PivotDialog::sliceDimension() const
+{
+    return 3 - m_rows->currentIndex() - m_columns->currentIndex();
+}
+
+QList<int> PivotDialog::values(int dimension) const
+{
+    //Every dimension ends with its roll-up, which doubles as the totals row or column
+    QList<int> result;
+
+    if(dimension == TeamDimension) {
+        result = m_cube.teams();
+        std::sort(result.begin(), result.end(), [](int a, int b) {
+            return TeamSymbols::instance().name(a).compare(TeamSymbols::instance().name(b), Qt::CaseInsensitive) < 0;
+        });
+    }
+    else if(dimension == MonthDimension)
+        result = m_cube.months();
+    else
+        result << RollupCube::Won << RollupCube::Lost;
+
+    result.append(any(dimension));
+    return result;
+}
+
+QString PivotDialog::label(int dimension, int value) const
+{
+    if(value == any(dimension))
+        return "Total";
+
+    if(dimension == TeamDimension)
+        return TeamSymbols::instance().name(value);
+    if(dimension == MonthDimension)
+        return RollupCube::firstDay(value).toString("yyyy.MM");
+
+    return value == RollupCube::Won ? "Won" : "Lost";
+}
+
+int PivotDialog::any(int dimension)
+{
+    return dimension == OutcomeDimension ? int(RollupCube::AnyOutcome) : RollupCube::Any;
+}
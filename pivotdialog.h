@@ -0,0 +1,48 @@
+#ifndef PIVOTDIALOG_H
+#define PIVOTDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLabel>
+#include <QTableWidget>
+#include "rollupcube.h"
+#include "moneyformat.h"
+
+//Pivot table over the rollup cube: two dimensions as rows and columns, the
+//third one sliced to a single value or rolled up. Every cell, including the
+//totals, is a cube lookup.
+class PivotDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    PivotDialog(const RollupCube& cube, const MoneyFormat& format, QWidget* parent = 0);
+
+public slots:
+    void refresh();
+
+private slots:
+    void rowsChanged();
+    void columnsChanged();
+
+private:
+    enum Dimension { TeamDimension, MonthDimension, OutcomeDimension };
+
+    const RollupCube& m_cube;
+    const MoneyFormat& m_format;
+
+    QComboBox* m_rows;
+    QComboBox* m_columns;
+    QComboBox* m_slice;
+    QComboBox* m_measure;
+    QLabel* m_sliceLabel;
+    QTableWidget* m_table;
+    int m_sliceDimension;
+
+    int sliceDimension() const;
+    QList<int> values(int dimension) const;
+    QString label(int dimension, int value) const;
+    static int any(int dimension);
+};
+
+#endif // PIVOTDIALOG_H
@@ -0,0 +1,119 @@
+#include "prefixtrie.h"
+#include <algorithm>
+
+PrefixTrie::PrefixTrie()
+{
+    clear();
+}
+
+void PrefixTrie::clear()
+{
+    m_nodes.clear();
+    m_terminals.clear();
+    m_weights.clear();
+
+    Node root;
+    root.parent = -1;
+    root.id = -1;
+    m_nodes.append(root);
+}
+
+void PrefixTrie::insert(int id, const QString& key)
+{
+    if(m_terminals.contains(id))
+        return;
+
+    int node = 0;
+    for(int i = 0; i < key.size(); i++) {
+        int next = child(node, key.at(i));
+        node = next != -1 ? next : addChild(node, key.at(i));
+    }
+
+    m_nodes[node].id = id;
+    m_terminals.insert(id, node);
+    updatePath(node);
+}
+
+void PrefixTrie::setWeight(int id, int weight)
+{
+    if(m_weights.value(id, 0) == weight)
+        return;
+
+    if(weight == 0)
+        m_weights.remove(id);
+    else
+        m_weights.insert(id, weight);
+
+    int node = m_terminals.value(id, -1);
+    if(node != -1)
+        updatePath(node);
+}
+
+QList<int> PrefixTrie::weightedIds() const
+{
+    return m_weights.keys();
+}
+
+QVector<int> PrefixTrie::complete(const QString& prefix, int limit) const
+{
+    int node = 0;
+    for(int i = 0; i < prefix.size() && node != -1; i++)
+        node = child(node, prefix.at(i));
+
+    if(node == -1)
+        return QVector<int>();
+
+    return m_nodes.at(node).top.mid(0, qMin(limit, TopCount));
+}
+
+int PrefixTrie::child(int node, QChar c) const
+{
+    //Children are kept sorted by character
+    const QVector<QPair<QChar, int> >& children = m_nodes.at(node).children;
+    QVector<QPair<QChar, int> >::const_iterator it = std::lower_bound(children.constBegin(), children.constEnd(), qMakePair(c, -1));
+
+    return it != children.constEnd() && it->first == c ? it->second : -1;
+}
+
+int PrefixTrie::addChild(int node, QChar c)
+{
+    Node next;
+    next.parent = node;
+    next.id = -1;
+    m_nodes.append(next);
+
+    int index = m_nodes.size() - 1;
+    QVector<QPair<QChar, int> >& children = m_nodes[node].children;
+    children.insert(std::lower_bound(children.begin(), children.end(), qMakePair(c, -1)), qMakePair(c, index));
+
+    return index;
+}
+
+bool PrefixTrie::ranksBefore(int a, int b) const
+{
+    //Heavier first, earlier interned ids break ties
+    int weightA = m_weights.value(a, 0), weightB = m_weights.value(b, 0);
+    return weightA != weightB ? weightA > weightB : a < b;
+}
+
+void PrefixTrie::updatePath(int node)
+{
+    //A node's top list is the best of its own key and its children's top lists,
+    //so recomputing bottom-up along one path keeps every cache exact
+    for(; node != -1; node = m_nodes.at(node).parent) {
+        QVector<int> candidates;
+        if(m_nodes.at(node).id != -1)
+            candidates.append(m_nodes.at(node).id);
+
+        const QVector<QPair<QChar, int> >& children = m_nodes.at(node).children;
+        for(int i = 0; i < children.size(); i++)
+            candidates += m_nodes.at(children.at(i).second).top;
+
+        int count = qMin(candidates.size(), int(TopCount));
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                          [this](int a, int b) { return ranksBefore(a, b); });
+        candidates.resize(count);
+
+        m_nodes[node].top = candidates;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef PREFIXTRIE_H
+#define PREFIXTRIE_H
+
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QString>
+
+//Prefix trie over case-folded keys. Every node caches the ids of its TopCount
+//highest weighted keys, so a completion costs one walk down the prefix and a
+//copy of that list, independent of how many keys share the prefix.
+class PrefixTrie
+{
+public:
+    static const int TopCount = 10;
+
+    PrefixTrie();
+
+    void clear();
+    int size() const { return m_terminals.size(); }
+
+    void insert(int id, const QString& key);
+    void setWeight(int id, int weight);
+    int weight(int id) const { return m_weights.value(id, 0); }
+    QList<int> weightedIds() const;
+
+    //Ids of the highest weighted keys starting with prefix, best first
+    QVector<int> complete(const QString& prefix, int limit = TopCount) const;
+
+private:
+    struct Node
+    {
+        int parent;
+        int id;
+        QVector<QPair<QChar, int> > children;
+        QVector<int> top;
+    };
+
+    QVector<Node> m_nodes;
+    QHash<int, int> m_terminals;
+    QHash<int, int> m_weights;
+
+    int child(int node, QChar c) const;
+    int addChild(int node, QChar c);
+    bool ranksBefore(int a, int b) const;
+    void updatePath(int node);
+};
+
+#endif // PREFIXTRIE_H
@@ -333,7 +333,10 @@ QCPScatterStyle::QCPScatterStyle() :
   mShape(ssNone),
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
-  mPenDefined(false)
+  mPenDefined(false),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -349,7 +352,10 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, double size) :
   mShape(shape),
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
-  mPenDefined(false)
+  mPenDefined(false),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -362,7 +368,10 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QColor &color, double
   mShape(shape),
   mPen(QPen(color)),
   mBrush(Qt::NoBrush),
-  mPenDefined(true)
+  mPenDefined(true),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -375,7 +384,10 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QColor &color, const
   mShape(shape),
   mPen(QPen(color)),
   mBrush(QBrush(fill)),
-  mPenDefined(true)
+  mPenDefined(true),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -399,7 +411,10 @@ QCPScatterStyle::QCPScatterStyle(ScatterShape shape, const QPen &pen, const QBru
   mShape(shape),
   mPen(pen),
   mBrush(brush),
-  mPenDefined(pen.style() != Qt::NoPen)
+  mPenDefined(pen.style() != Qt::NoPen),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -413,7 +428,10 @@ QCPScatterStyle::QCPScatterStyle(const QPixmap &pixmap) :
   mPen(Qt::NoPen),
   mBrush(Qt::NoBrush),
   mPixmap(pixmap),
-  mPenDefined(false)
+  mPenDefined(false),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -432,7 +450,10 @@ QCPScatterStyle::QCPScatterStyle(const QPainterPath &customPath, const QPen &pen
   mPen(pen),
   mBrush(brush),
   mCustomPath(customPath),
-  mPenDefined(pen.style() != Qt::NoPen)
+  mPenDefined(pen.style() != Qt::NoPen),
+  mSpriteRatio(0),
+  mSpriteAntialiased(false),
+  mSpriteOffset(0)
 {
 }
 
@@ -444,6 +465,7 @@ QCPScatterStyle::QCPScatterStyle(const QPainterPath &customPath, const QPen &pen
 void QCPScatterStyle::setSize(double size)
 {
   mSize = size;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -457,6 +479,7 @@ void QCPScatterStyle::setSize(double size)
 void QCPScatterStyle::setShape(QCPScatterStyle::ScatterShape shape)
 {
   mShape = shape;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -506,6 +529,7 @@ void QCPScatterStyle::setCustomPath(const QPainterPath &customPath)
 {
   setShape(ssCustom);
   mCustomPath = customPath;
+  mSprite = QPixmap();
 }
 
 /*!
@@ -529,6 +553,12 @@ void QCPScatterStyle::applyTo(QCPPainter *painter, const QPen &defaultPen) const
   This function does not modify the pen or the brush on the painter, as \ref applyTo is meant to be
   called before scatter points are drawn with \ref drawShape.
   
+  When drawing to the screen, the shape is rasterized once into a sprite for the current pen, brush,
+  antialiasing and device pixel ratio of \a painter, and every further point is a pixmap blit of that
+  sprite. Sprite positions are snapped to the device pixel grid. Exports (\ref
+  QCPPainter::pmVectorized, \ref QCPPainter::pmNoCaching) and painters with a scaling or rotating
+  transform always draw the vectorized shape.
+  
   \see applyTo
 */
 void QCPScatterStyle::drawShape(QCPPainter *painter, QPointF pos) const
@@ -540,6 +570,84 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, QPointF pos) const
   Draws the scatter shape with \a painter at position \a x and \a y.
 */
 void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
+{
+  if (updateSprite(painter))
+  {
+    painter->drawPixmap(QPointF(qRound((x-mSpriteOffset)*mSpriteRatio)/mSpriteRatio,
+                                qRound((y-mSpriteOffset)*mSpriteRatio)/mSpriteRatio), mSprite);
+  } else
+    drawShapeVectorized(painter, x, y);
+}
+
+/*! \internal
+  
+  Makes sure the cached sprite matches the current pen, brush, antialiasing and device pixel ratio
+  of \a painter, rasterizing it again if not. Returns false if the shape should be drawn vectorized
+  instead, see \ref drawShape.
+*/
+bool QCPScatterStyle::updateSprite(QCPPainter *painter) const
+{
+  // dots are a single line and pixmaps already are one, nothing to gain there:
+  if (mShape == ssNone || mShape == ssDot || mShape == ssPixmap)
+    return false;
+  if (painter->modes().testFlag(QCPPainter::pmVectorized) || painter->modes().testFlag(QCPPainter::pmNoCaching))
+    return false;
+  if (painter->transform().type() > QTransform::TxTranslate)
+    return false;
+  
+  double ratio = 1;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+  ratio = painter->device()->devicePixelRatioF();
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+  ratio = painter->device()->devicePixelRatio();
+#endif
+  bool antialiased = painter->antialiasing();
+  // pens and brushes compare by their shared data first, so the per-point check is cheap:
+  if (!mSprite.isNull() && ratio == mSpriteRatio && antialiased == mSpriteAntialiased &&
+      painter->pen() == mSpritePen && painter->brush() == mSpriteBrush)
+    return true;
+  
+  // the shape reaches half its size from the center (custom paths are scaled by size/6), plus the pen:
+  double extent = mSize*0.5;
+  if (mShape == ssCustom)
+  {
+    QRectF bounds = mCustomPath.boundingRect();
+    extent = qMax(qMax(qAbs(bounds.left()), qAbs(bounds.right())), qMax(qAbs(bounds.top()), qAbs(bounds.bottom())))*mSize/6.0;
+  }
+  extent += qMax(painter->pen().widthF(), 1.0) + 1;
+  int side = qCeil(2*extent*ratio);
+  if (side > 256) // large glyphs are few, a sprite would mostly hold transparent pixels
+    return false;
+  
+  QPixmap sprite(side, side);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 1, 0)
+  sprite.setDevicePixelRatio(ratio);
+#endif
+  sprite.fill(Qt::transparent);
+  double center = side/ratio*0.5;
+  QCPPainter spritePainter(&sprite);
+  spritePainter.setAntialiasing(antialiased);
+  spritePainter.setPen(painter->pen());
+  spritePainter.setBrush(painter->brush());
+  drawShapeVectorized(&spritePainter, center, center);
+  spritePainter.end();
+  
+  mSprite = sprite;
+  mSpritePen = painter->pen();
+  mSpriteBrush = painter->brush();
+  mSpriteRatio = ratio;
+  mSpriteAntialiased = antialiased;
+  mSpriteOffset = center;
+  return true;
+}
+
+/*! \internal
+  
+  Draws the scatter shape with \a painter at position \a x and \a y as vector graphics. This is what
+  \ref drawShape falls back to when the cached sprite can't be used, and what the sprite is rendered
+  with.
+*/
+void QCPScatterStyle::drawShapeVectorized(QCPPainter *painter, double x, double y) const
 {
   double w = mSize/2.0;
   switch (mShape)
@@ -664,6 +772,159 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPTextAtlas
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPTextAtlas
+  \brief Plot-wide cache of texts rendered to pixmaps
+  
+  Each QCustomPlot owns one text atlas (see \ref QCustomPlot::textAtlas). It is shared by all axes
+  for their tick labels, by QCPItemText and by the legend items, so a label that appears on several
+  axes or in several replots is rendered only once. It is used as long as the plotting hint \ref
+  QCP::phCacheLabels is set and the painter isn't in \ref QCPPainter::pmNoCaching mode (exports).
+  
+  Entries are looked up by a key that starts with \ref styleKey (font, color and rotation) and ends
+  with the text. Callers that render the text differently (e.g. the tick labels with beautifully
+  typeset powers) add their parameters to the style part of the key.
+  
+  The atlas is bounded by the memory its pixmaps occupy (\ref setMemoryLimit); when the limit is
+  exceeded, the least recently used entries are discarded. \ref hits and \ref misses count the
+  lookups via \ref find and \ref textEntry, to judge whether the limit fits the plot.
+*/
+
+/*!
+  Creates a text atlas that holds pixmaps of at most \a memoryLimit bytes.
+*/
+QCPTextAtlas::QCPTextAtlas(int memoryLimit) :
+  mCache(memoryLimit),
+  mHits(0),
+  mMisses(0)
+{
+}
+
+/*!
+  Sets the maximum number of bytes the pixmaps in the atlas may occupy. If the atlas currently
+  holds more, the least recently used entries are discarded.
+*/
+void QCPTextAtlas::setMemoryLimit(int bytes)
+{
+  mCache.setMaxCost(qMax(0, bytes));
+}
+
+/*!
+  Returns the entry stored under \a key and marks it as recently used, or 0 if there is none. The
+  lookup is counted in \ref hits or \ref misses.
+  
+  The returned pointer is only valid until the next call to \ref insert or \ref textEntry, which
+  may discard entries.
+*/
+const QCPTextAtlas::Entry *QCPTextAtlas::find(const QByteArray &key)
+{
+  const Entry *entry = mCache.object(key);
+  if (entry)
+    ++mHits;
+  else
+    ++mMisses;
+  return entry;
+}
+
+/*!
+  Like \ref find, but doesn't count the lookup. This is used to measure texts that may already be
+  cached without drawing them, e.g. for margin calculations.
+*/
+const QCPTextAtlas::Entry *QCPTextAtlas::peek(const QByteArray &key) const
+{
+  return mCache.object(key);
+}
+
+/*!
+  Stores a copy of \a entry under \a key and returns a pointer to the stored entry. The cost of the
+  entry is the memory occupied by its pixmap.
+  
+  If the pixmap alone exceeds the \ref memoryLimit, it is not cached. The returned pointer then
+  refers to an internal entry that is overwritten by the next insert of that kind.
+*/
+const QCPTextAtlas::Entry *QCPTextAtlas::insert(const QByteArray &key, const Entry &entry)
+{
+  int cost = qMax(1, entry.pixmap.width()*entry.pixmap.height()*qMax(1, entry.pixmap.depth()/8));
+  if (cost <= mCache.maxCost())
+  {
+    Entry *stored = new Entry(entry);
+    if (mCache.insert(key, stored, cost))
+      return stored;
+  }
+  mUncached = entry;
+  return &mUncached;
+}
+
+/*!
+  Returns the entry for the unrotated \a text drawn with \a font, \a color and the Qt::TextFlag and
+  Qt::AlignmentFlag combination \a flags, rendering it first if it isn't cached yet.
+  
+  The pixmap covers the text's bounding rect as given by QFontMetrics::boundingRect, so drawing it
+  at the top left of that rect is equivalent to QPainter::drawText with the same \a flags. The
+  origin of the entry is zero.
+*/
+const QCPTextAtlas::Entry *QCPTextAtlas::textEntry(const QFont &font, const QColor &color, const QString &text, int flags)
+{
+  QByteArray key = styleKey(font, color, 0);
+  key.append(QByteArray::number(flags));
+  key.append('\n');
+  key.append(text.toUtf8());
+  if (const Entry *entry = find(key))
+    return entry;
+  
+  Entry entry;
+  QRect bounds = QFontMetrics(font).boundingRect(0, 0, 0, 0, flags, text);
+  bounds.moveTopLeft(QPoint(0, 0));
+  entry.textSize = bounds.size();
+  entry.pixmap = QPixmap(bounds.size().expandedTo(QSize(1, 1)));
+  entry.pixmap.fill(Qt::transparent);
+  {
+    QCPPainter painter(&entry.pixmap);
+    painter.setFont(font);
+    painter.setPen(color);
+    painter.drawText(bounds, flags, text);
+  }
+  return insert(key, entry);
+}
+
+/*!
+  Discards all entries. The hit and miss counters are left untouched, see \ref resetStatistics.
+*/
+void QCPTextAtlas::clear()
+{
+  mCache.clear();
+  mUncached = Entry();
+}
+
+/*!
+  Sets the \ref hits and \ref misses counters to zero.
+*/
+void QCPTextAtlas::resetStatistics()
+{
+  mHits = 0;
+  mMisses = 0;
+}
+
+/*!
+  Returns the style part of an atlas key for texts drawn with \a font, \a color and \a rotation (in
+  degrees).
+*/
+QByteArray QCPTextAtlas::styleKey(const QFont &font, const QColor &color, double rotation)
+{
+  QByteArray result;
+  result.append(font.toString().toUtf8());
+  result.append('|');
+  result.append(QByteArray::number(color.rgba(), 16));
+  result.append('|');
+  result.append(QByteArray::number(rotation));
+  result.append('|');
+  return result;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPLayer
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1213,6 +1474,42 @@ QRect QCPLayerable::clipRect() const
     return QRect();
 }
 
+/*! \internal
+  
+  Returns a rect in pixels that contains everything the \ref draw function would paint, or an
+  invalid rect if the layerable can't tell cheaply. This is the default.
+  
+  QCustomPlot uses the bounds to skip layerables that lie entirely outside their \ref clipRect,
+  both when drawing and when looking for the layerable under the cursor (\ref
+  QCustomPlot::layerableAt). This keeps plots with many small layerables, e.g. thousands of
+  annotation items of which only a few are inside the axis rect, as fast as plots with just the
+  visible ones. Reimplementations must therefore be cheap and rather too large than too small.
+  
+  The function isn't const because some layerables need to update their state before they know
+  where they are (see \ref QCPItemTracer::updatePosition).
+*/
+QRectF QCPLayerable::pixelBounds()
+{
+  return QRectF();
+}
+
+/*! \internal
+  
+  Returns whether \a other may be drawn right after this layerable with the same painter setup,
+  i.e. without restoring and saving the painter state and setting clip rect and default
+  antialiasing hint again. QCustomPlot only asks this for subsequent layerables of the same layer
+  with equal \ref clipRect.
+  
+  A layerable may only return true if its \ref draw function sets all painter state it relies on
+  (pen, brush, font) and leaves the painter transform and clipping as it found them, and if \a
+  other has the same default antialiasing hint. The default implementation returns false.
+*/
+bool QCPLayerable::batchableWith(const QCPLayerable *other) const
+{
+  Q_UNUSED(other)
+  return false;
+}
+
 /*! \internal
   
   This event is called when the layerable shall be selected, as a consequence of a click by the
@@ -1777,6 +2074,10 @@ void QCPLayoutElement::setMargins(const QMargins &margins)
   {
     mMargins = margins;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    // margins may enter the size hints (e.g. of nested layouts), so the parent must not reuse its cached
+    // layout. No QWidget::updateGeometry here, automatic margins change with tick label widths during replots:
+    if (mParentLayout)
+      mParentLayout->invalidateLayoutCache();
   }
 }
 
@@ -1942,6 +2243,23 @@ void QCPLayoutElement::update(UpdatePhase phase)
   }
 }
 
+/*!
+  Notifies the parent layout that the values returned by \ref minimumSizeHint or \ref
+  maximumSizeHint have changed.
+  
+  Layouts like QCPLayoutGrid cache the size constraints of their elements and only query them again
+  when elements are added or removed, margins change or this method is called. Subclasses that
+  reimplement \ref minimumSizeHint or \ref maximumSizeHint with values depending on their content
+  (e.g. text and font, like QCPPlotTitle) must call this method whenever that content changes.
+  Changes to \ref setMinimumSize, \ref setMaximumSize and \ref setMargins are reported
+  automatically.
+*/
+void QCPLayoutElement::invalidateSizeHints()
+{
+  if (mParentLayout)
+    mParentLayout->sizeConstraintsChanged();
+}
+
 /*!
   Returns the minimum size this layout element (the inner \ref rect) may be compressed to.
   
@@ -2237,13 +2555,15 @@ void QCPLayout::clear()
 /*!
   Subclasses call this method to report changed (minimum/maximum) size constraints.
   
-  If the parent of this layout is again a QCPLayout, forwards the call to the parent's \ref
-  sizeConstraintsChanged. If the parent is a QWidget (i.e. is the \ref QCustomPlot::plotLayout of
-  QCustomPlot), calls QWidget::updateGeometry, so if the QCustomPlot widget is inside a Qt QLayout,
-  it may update itself and resize cells accordingly.
+  Invalidates the cached layout of this layout (see \ref invalidateLayoutCache). If the parent of
+  this layout is again a QCPLayout, forwards the call to the parent's \ref sizeConstraintsChanged.
+  If the parent is a QWidget (i.e. is the \ref QCustomPlot::plotLayout of QCustomPlot), calls
+  QWidget::updateGeometry, so if the QCustomPlot widget is inside a Qt QLayout, it may update
+  itself and resize cells accordingly.
 */
-void QCPLayout::sizeConstraintsChanged() const
+void QCPLayout::sizeConstraintsChanged()
 {
+  invalidateLayoutCache();
   if (QWidget *w = qobject_cast<QWidget*>(parent()))
     w->updateGeometry();
   else if (QCPLayout *l = qobject_cast<QCPLayout*>(parent()))
@@ -2260,12 +2580,30 @@ void QCPLayout::sizeConstraintsChanged() const
   
   \ref getSectionSizes may help with the reimplementation of this function.
   
+  Layouts that cache the results of this function between replots must discard the cache in their
+  reimplementation of \ref invalidateLayoutCache.
+  
   \see update
 */
 void QCPLayout::updateLayout()
 {
 }
 
+/*! \internal
+  
+  Called when the size constraints of this layout's elements, their margins or the set of elements
+  itself changed, so a layout computed in a previous \ref updateLayout can't be reused.
+  Reimplementations discard their cached results and call the base class implementation.
+  
+  Since the size hints of a layout are derived from its elements, the default implementation
+  forwards the call to the parent layout.
+*/
+void QCPLayout::invalidateLayoutCache()
+{
+  if (mParentLayout)
+    mParentLayout->invalidateLayoutCache();
+}
+
 
 /*! \internal
   
@@ -2288,6 +2626,7 @@ void QCPLayout::adoptElement(QCPLayoutElement *el)
     el->setParent(this);
     if (!el->parentPlot())
       el->initializeParentPlot(mParentPlot);
+    invalidateLayoutCache();
   } else
     qDebug() << Q_FUNC_INFO << "Null element passed";
 }
@@ -2310,6 +2649,7 @@ void QCPLayout::releaseElement(QCPLayoutElement *el)
     el->setParentLayerable(0);
     el->setParent(mParentPlot);
     // Note: Don't initializeParentPlot(0) here, because layout element will stay in same parent plot
+    invalidateLayoutCache();
   } else
     qDebug() << Q_FUNC_INFO << "Null element passed";
 }
@@ -2475,6 +2815,11 @@ QVector<int> QCPLayout::getSectionSizes(QVector<int> maxSizes, QVector<int> minS
   remove.
   
   Row and column insertion can be performed with \ref insertRow and \ref insertColumn.
+  
+  The row and column constraints gathered from the elements' size hints and the resulting section
+  sizes are cached between replots. They are only computed again when the layout is resized,
+  elements are added or removed, or an element reports changed margins or size constraints (see
+  \ref QCPLayoutElement::invalidateSizeHints).
 */
 
 /*!
@@ -2482,7 +2827,9 @@ QVector<int> QCPLayout::getSectionSizes(QVector<int> maxSizes, QVector<int> minS
 */
 QCPLayoutGrid::QCPLayoutGrid() :
   mColumnSpacing(5),
-  mRowSpacing(5)
+  mRowSpacing(5),
+  mConstraintsCacheValid(false),
+  mSectionsCacheValid(false)
 {
 }
 
@@ -2600,8 +2947,10 @@ void QCPLayoutGrid::setColumnStretchFactor(int column, double factor)
   if (column >= 0 && column < columnCount())
   {
     if (factor > 0)
+    {
       mColumnStretchFactors[column] = factor;
-    else
+      mSectionsCacheValid = false;
+    } else
       qDebug() << Q_FUNC_INFO << "Invalid stretch factor, must be positive:" << factor;
   } else
     qDebug() << Q_FUNC_INFO << "Invalid column:" << column;
@@ -2631,6 +2980,7 @@ void QCPLayoutGrid::setColumnStretchFactors(const QList<double> &factors)
         mColumnStretchFactors[i] = 1;
       }
     }
+    mSectionsCacheValid = false;
   } else
     qDebug() << Q_FUNC_INFO << "Column count not equal to passed stretch factor count:" << factors;
 }
@@ -2651,8 +3001,10 @@ void QCPLayoutGrid::setRowStretchFactor(int row, double factor)
   if (row >= 0 && row < rowCount())
   {
     if (factor > 0)
+    {
       mRowStretchFactors[row] = factor;
-    else
+      mSectionsCacheValid = false;
+    } else
       qDebug() << Q_FUNC_INFO << "Invalid stretch factor, must be positive:" << factor;
   } else
     qDebug() << Q_FUNC_INFO << "Invalid row:" << row;
@@ -2682,6 +3034,7 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
         mRowStretchFactors[i] = 1;
       }
     }
+    mSectionsCacheValid = false;
   } else
     qDebug() << Q_FUNC_INFO << "Row count not equal to passed stretch factor count:" << factors;
 }
@@ -2693,7 +3046,11 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
 */
 void QCPLayoutGrid::setColumnSpacing(int pixels)
 {
-  mColumnSpacing = pixels;
+  if (mColumnSpacing != pixels)
+  {
+    mColumnSpacing = pixels;
+    invalidateLayoutCache();
+  }
 }
 
 /*!
@@ -2703,7 +3060,11 @@ void QCPLayoutGrid::setColumnSpacing(int pixels)
 */
 void QCPLayoutGrid::setRowSpacing(int pixels)
 {
-  mRowSpacing = pixels;
+  if (mRowSpacing != pixels)
+  {
+    mRowSpacing = pixels;
+    invalidateLayoutCache();
+  }
 }
 
 /*!
@@ -2737,6 +3098,7 @@ void QCPLayoutGrid::expandTo(int newRowCount, int newColumnCount)
   }
   while (mColumnStretchFactors.size() < newColCount)
     mColumnStretchFactors.append(1);
+  invalidateLayoutCache();
 }
 
 /*!
@@ -2763,6 +3125,7 @@ void QCPLayoutGrid::insertRow(int newIndex)
   for (int col=0; col<columnCount(); ++col)
     newRow.append((QCPLayoutElement*)0);
   mElements.insert(newIndex, newRow);
+  invalidateLayoutCache();
 }
 
 /*!
@@ -2787,21 +3150,28 @@ void QCPLayoutGrid::insertColumn(int newIndex)
   mColumnStretchFactors.insert(newIndex, 1);
   for (int row=0; row<rowCount(); ++row)
     mElements[row].insert(newIndex, (QCPLayoutElement*)0);
+  invalidateLayoutCache();
 }
 
 /* inherits documentation from base class */
 void QCPLayoutGrid::updateLayout()
 {
-  QVector<int> minColWidths, minRowHeights, maxColWidths, maxRowHeights;
-  getMinimumRowColSizes(&minColWidths, &minRowHeights);
-  getMaximumRowColSizes(&maxColWidths, &maxRowHeights);
-  
-  int totalRowSpacing = (rowCount()-1) * mRowSpacing;
-  int totalColSpacing = (columnCount()-1) * mColumnSpacing;
-  QVector<int> colWidths = getSectionSizes(maxColWidths, minColWidths, mColumnStretchFactors.toVector(), mRect.width()-totalColSpacing);
-  QVector<int> rowHeights = getSectionSizes(maxRowHeights, minRowHeights, mRowStretchFactors.toVector(), mRect.height()-totalRowSpacing);
+  // the section sizes only depend on the size (not the position) of the rect and on the row/column
+  // constraints, so they can be reused until one of those changes:
+  updateConstraintsCache();
+  if (!mSectionsCacheValid || mCachedSectionsSize != mRect.size())
+  {
+    int totalRowSpacing = (rowCount()-1) * mRowSpacing;
+    int totalColSpacing = (columnCount()-1) * mColumnSpacing;
+    mCachedColWidths = getSectionSizes(mCachedMaxColWidths, mCachedMinColWidths, mColumnStretchFactors.toVector(), mRect.width()-totalColSpacing);
+    mCachedRowHeights = getSectionSizes(mCachedMaxRowHeights, mCachedMinRowHeights, mRowStretchFactors.toVector(), mRect.height()-totalRowSpacing);
+    mCachedSectionsSize = mRect.size();
+    mSectionsCacheValid = true;
+  }
+  const QVector<int> &colWidths = mCachedColWidths;
+  const QVector<int> &rowHeights = mCachedRowHeights;
   
-  // go through cells and set rects accordingly:
+  // go through cells and set rects accordingly (elements whose outer rect doesn't change keep their state):
   int yOffset = mRect.top();
   for (int row=0; row<rowCount(); ++row)
   {
@@ -2940,13 +3310,15 @@ void QCPLayoutGrid::simplify()
         mElements[row].removeAt(col);
     }
   }
+  invalidateLayoutCache();
 }
 
 /* inherits documentation from base class */
 QSize QCPLayoutGrid::minimumSizeHint() const
 {
-  QVector<int> minColWidths, minRowHeights;
-  getMinimumRowColSizes(&minColWidths, &minRowHeights);
+  updateConstraintsCache();
+  const QVector<int> &minColWidths = mCachedMinColWidths;
+  const QVector<int> &minRowHeights = mCachedMinRowHeights;
   QSize result(0, 0);
   for (int i=0; i<minColWidths.size(); ++i)
     result.rwidth() += minColWidths.at(i);
@@ -2960,8 +3332,9 @@ QSize QCPLayoutGrid::minimumSizeHint() const
 /* inherits documentation from base class */
 QSize QCPLayoutGrid::maximumSizeHint() const
 {
-  QVector<int> maxColWidths, maxRowHeights;
-  getMaximumRowColSizes(&maxColWidths, &maxRowHeights);
+  updateConstraintsCache();
+  const QVector<int> &maxColWidths = mCachedMaxColWidths;
+  const QVector<int> &maxRowHeights = mCachedMaxRowHeights;
   
   QSize result(0, 0);
   for (int i=0; i<maxColWidths.size(); ++i)
@@ -3041,6 +3414,33 @@ void QCPLayoutGrid::getMaximumRowColSizes(QVector<int> *maxColWidths, QVector<in
   }
 }
 
+/*! \internal
+  
+  Gathers the row and column constraints via \ref getMinimumRowColSizes and \ref
+  getMaximumRowColSizes, unless they are still cached from a previous call. The cache is discarded
+  in \ref invalidateLayoutCache.
+  
+  This is a helper function for \ref updateLayout, \ref minimumSizeHint and \ref maximumSizeHint,
+  which parent layouts call on every replot.
+*/
+void QCPLayoutGrid::updateConstraintsCache() const
+{
+  if (!mConstraintsCacheValid)
+  {
+    getMinimumRowColSizes(&mCachedMinColWidths, &mCachedMinRowHeights);
+    getMaximumRowColSizes(&mCachedMaxColWidths, &mCachedMaxRowHeights);
+    mConstraintsCacheValid = true;
+  }
+}
+
+/* inherits documentation from base class */
+void QCPLayoutGrid::invalidateLayoutCache()
+{
+  mConstraintsCacheValid = false;
+  mSectionsCacheValid = false;
+  QCPLayout::invalidateLayoutCache();
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPLayoutInset
@@ -4013,6 +4413,7 @@ QCPAxis::QCPAxis(QCPAxisRect *parent, AxisType type) :
   mSelectedTickLabelColor(Qt::blue),
   mDateTimeFormat(QLatin1String("hh:mm:ss\ndd.MM.yy")),
   mDateTimeSpec(Qt::LocalTime),
+  mCalendarTicks(false),
   mNumberPrecision(6),
   mNumberFormatChar('g'),
   mNumberBeautifulPowers(true),
@@ -4040,12 +4441,14 @@ QCPAxis::QCPAxis(QCPAxisRect *parent, AxisType type) :
   mLowestVisibleTick(0),
   mHighestVisibleTick(-1),
   mCachedMarginValid(false),
-  mCachedMargin(0)
+  mCachedMargin(0),
+  mTickCacheValid(false)
 {
   setParent(parent);
   mGrid->setVisible(false);
   setAntialiased(false);
   setLayer(mParentPlot->currentLayer()); // it's actually on that layer already, but we want it in front of the grid, so we place it on there again
+  mTickCacheKey = tickCacheKey();
   
   if (type == atTop)
   {
@@ -4173,6 +4576,7 @@ void QCPAxis::setScaleType(QCPAxis::ScaleType type)
     if (mScaleType == stLogarithmic)
       setRange(mRange.sanitizedForLogScale());
     mCachedMarginValid = false;
+    mParentPlot->invalidateItemPositions();
     emit scaleTypeChanged(mScaleType);
   }
 }
@@ -4191,6 +4595,7 @@ void QCPAxis::setScaleLogBase(double base)
     mScaleLogBase = base;
     mScaleLogBaseLogInv = 1.0/qLn(mScaleLogBase); // buffer for faster baseLog() calculation
     mCachedMarginValid = false;
+    mParentPlot->invalidateItemPositions();
   } else
     qDebug() << Q_FUNC_INFO << "Invalid logarithmic scale base (must be greater 1):" << base;
 }
@@ -4218,6 +4623,7 @@ void QCPAxis::setRange(const QCPRange &range)
     mRange = range.sanitizedForLinScale();
   }
   mCachedMarginValid = false;
+  mParentPlot->invalidateItemPositions();
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -4291,6 +4697,7 @@ void QCPAxis::setRange(double lower, double upper)
     mRange = mRange.sanitizedForLinScale();
   }
   mCachedMarginValid = false;
+  mParentPlot->invalidateItemPositions();
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -4335,6 +4742,7 @@ void QCPAxis::setRangeLower(double lower)
     mRange = mRange.sanitizedForLinScale();
   }
   mCachedMarginValid = false;
+  mParentPlot->invalidateItemPositions();
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -4358,6 +4766,7 @@ void QCPAxis::setRangeUpper(double upper)
     mRange = mRange.sanitizedForLinScale();
   }
   mCachedMarginValid = false;
+  mParentPlot->invalidateItemPositions();
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -4377,6 +4786,7 @@ void QCPAxis::setRangeReversed(bool reversed)
   {
     mRangeReversed = reversed;
     mCachedMarginValid = false;
+    mParentPlot->invalidateItemPositions();
   }
 }
 
@@ -4652,6 +5062,23 @@ void QCPAxis::setDateTimeSpec(const Qt::TimeSpec &timeSpec)
   mDateTimeSpec = timeSpec;
 }
 
+/*!
+  Sets whether automatically generated ticks of a date time axis (\ref setTickLabelType is \ref
+  ltDateTime) are placed on calendar boundaries: full hours, midnights, Mondays, first days of
+  months and first days of years, depending on the range. Tick steps that aren't whole hours or
+  calendar units, as the regular tick step algorithm produces them for seconds, are avoided.
+  
+  The boundaries are those of the time spec set with \ref setDateTimeSpec. Ticks are only placed
+  this way if \ref setAutoTickStep is enabled. Ranges that would need ticks finer than an hour
+  fall back to the regular tick step algorithm.
+  
+  \see setDateTimeFormat
+*/
+void QCPAxis::setCalendarTicks(bool enabled)
+{
+  mCalendarTicks = enabled;
+}
+
 /*!
   Sets the number format for the numbers drawn as tick labels (if tick label type is \ref
   ltNumber). This \a formatCode is an extended version of the format code used e.g. by
@@ -4795,6 +5222,7 @@ void QCPAxis::setTickVector(const QVector<double> &vec)
   // don't check whether mTickVector != vec here, because it takes longer than we would save
   mTickVector = vec;
   mCachedMarginValid = false;
+  mTickCacheValid = false;
 }
 
 /*!
@@ -4813,6 +5241,7 @@ void QCPAxis::setTickVectorLabels(const QVector<QString> &vec)
   // don't check whether mTickVectorLabels != vec here, because it takes longer than we would save
   mTickVectorLabels = vec;
   mCachedMarginValid = false;
+  mTickCacheValid = false;
 }
 
 /*!
@@ -5160,6 +5589,7 @@ void QCPAxis::moveRange(double diff)
     mRange.upper *= diff;
   }
   mCachedMarginValid = false;
+  mParentPlot->invalidateItemPositions();
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -5193,6 +5623,7 @@ void QCPAxis::scaleRange(double factor, double center)
       qDebug() << Q_FUNC_INFO << "Center of scaling operation doesn't lie in same logarithmic sign domain as range:" << center;
   }
   mCachedMarginValid = false;
+  mParentPlot->invalidateItemPositions();
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -5510,12 +5941,26 @@ QCPAxis::AxisType QCPAxis::opposite(QCPAxis::AxisType type)
   \ref setAutoTicks is set to true, appropriate tick values are determined automatically via \ref
   generateAutoTicks. If it's set to false, the signal ticksRequest is emitted, which can be used to
   provide external tick positions. Then the sub tick vectors and tick label vectors are created.
+  
+  If both ticks and tick labels are generated automatically, the result is memoized: As long as
+  none of the inputs (range, scale type, tick step settings, label type and format, locale) changed
+  since the last call, the vectors are left as they are. Tick labels are additionally kept per tick
+  coordinate, so when panning only the ticks entering the visible range need to be formatted.
 */
 void QCPAxis::setupTickVectors()
 {
   if (!mParentPlot) return;
   if ((!mTicks && !mTickLabels && !mGrid->visible()) || mRange.size() <= 0) return;
   
+  const bool memoize = mAutoTicks && mAutoTickLabels;
+  const TickCacheKey key = tickCacheKey();
+  if (memoize && mTickCacheValid && sameTicks(key, mTickCacheKey) && sameTickLabels(key, mTickCacheKey))
+    return;
+  if (!sameTickLabels(key, mTickCacheKey))
+    mTickLabelCache.clear();
+  mTickCacheKey = key;
+  mTickCacheValid = false;
+  
   // fill tick vectors, either by auto generating or by notifying user to fill the vectors himself
   if (mAutoTicks)
   {
@@ -5568,21 +6013,18 @@ void QCPAxis::setupTickVectors()
   {
     int vecsize = mTickVector.size();
     mTickVectorLabels.resize(vecsize);
-    if (mTickLabelType == ltNumber)
-    {
-      for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
-        mTickVectorLabels[i] = mParentPlot->locale().toString(mTickVector.at(i), mNumberFormatChar.toLatin1(), mNumberPrecision);
-    } else if (mTickLabelType == ltDateTime)
-    {
-      for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
-      {
-#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0) // use fromMSecsSinceEpoch function if available, to gain sub-second accuracy on tick labels (e.g. for format "hh:mm:ss:zzz")
-        mTickVectorLabels[i] = mParentPlot->locale().toString(QDateTime::fromTime_t(mTickVector.at(i)).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
-#else
-        mTickVectorLabels[i] = mParentPlot->locale().toString(QDateTime::fromMSecsSinceEpoch(mTickVector.at(i)*1000).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
-#endif
-      }
-    }
+    // reuse labels of ticks that were already visible in the previous call, and only keep the ones
+    // visible now, so the label cache doesn't grow while zooming:
+    QMap<double, QString> labelCache;
+    for (int i=mLowestVisibleTick; i<=mHighestVisibleTick; ++i)
+    {
+      const double tick = mTickVector.at(i);
+      QMap<double, QString>::const_iterator it = mTickLabelCache.constFind(tick);
+      mTickVectorLabels[i] = it != mTickLabelCache.constEnd() ? it.value() : formatTickLabel(tick);
+      labelCache.insert(tick, mTickVectorLabels.at(i));
+    }
+    mTickLabelCache = labelCache;
+    mTickCacheValid = memoize;
   } else // mAutoTickLabels == false
   {
     if (mAutoTicks) // ticks generated automatically, but not ticklabels, so emit ticksRequest here for labels
@@ -5595,6 +6037,192 @@ void QCPAxis::setupTickVectors()
   }
 }
 
+/*! \internal
+  
+  Generates the tick vector, tick step and (if \ref setAutoSubTicks is enabled) sub tick count for
+  \ref setCalendarTicks. Called by \ref generateAutoTicks.
+  
+  Tick positions are calculated with seconds and julian day numbers, so no QDateTime is created per
+  tick. For local time, the offset to UTC is determined once, in the middle of the range. In a range
+  that spans a daylight saving time change, the ticks on one side are thus off by an hour.
+  
+  Returns false if the range would need ticks finer than an hour, or is too large for the calendar.
+  The tick vector is left untouched then.
+*/
+bool QCPAxis::generateCalendarTicks()
+{
+  const double hour = 3600;
+  const double day = 24*hour;
+  const qint64 epochJulianDay = 2440588; // 1970-01-01
+  const double targetStep = mRange.size()/(double)(mAutoTickCount+1e-10);
+  if (targetStep < hour || qAbs(mRange.lower) > 1e13 || qAbs(mRange.upper) > 1e13) // 1e13 seconds are about 300000 years
+    return false;
+  
+  // shift to the time spec of the labels, so ticks fall on its midnights:
+  double utcOffset = 0;
+  if (mDateTimeSpec != Qt::UTC)
+  {
+    QDateTime local = QDateTime::fromTime_t(uint(qBound(0.0, mRange.center(), 4294967295.0)));
+    utcOffset = local.secsTo(QDateTime(local.date(), local.time(), Qt::UTC));
+  }
+  const double lower = mRange.lower+utcOffset;
+  const double upper = mRange.upper+utcOffset;
+  
+  // steps of fixed length, in hours up to two weeks:
+  const int fixedStepCount = 9;
+  const double fixedSteps[fixedStepCount] = {1, 2, 3, 6, 12, 24, 48, 7*24, 14*24};
+  const int fixedSubTicks[fixedStepCount] = {3, 3, 2, 5, 3, 3, 1, 6, 1};
+  for (int i=0; i<fixedStepCount; ++i)
+  {
+    const double step = fixedSteps[i]*hour;
+    if (step < targetStep)
+      continue;
+    const double phase = step >= 7*day ? 4*day : 0; // weeks start on Mondays, 1970-01-05 was the first
+    qint64 firstStep = floor((lower-phase)/step); // do not use qFloor here, or we'll lose 64 bit precision
+    qint64 lastStep = ceil((upper-phase)/step);
+    mTickStep = step;
+    if (mAutoSubTicks)
+      mSubTickCount = fixedSubTicks[i];
+    mTickVector.resize(lastStep-firstStep+1);
+    for (int k=0; k<mTickVector.size(); ++k)
+      mTickVector[k] = phase+(firstStep+k)*step-utcOffset;
+    return true;
+  }
+  
+  // steps of whole months and years, which vary in length:
+  const double targetMonths = targetStep/(30.436875*day);
+  int monthStep = 1;
+  int subTickCount = 1;
+  if (targetMonths <= 1)
+  {
+    monthStep = 1;
+    subTickCount = 1;
+  } else if (targetMonths <= 2)
+  {
+    monthStep = 2;
+    subTickCount = 1;
+  } else if (targetMonths <= 3)
+  {
+    monthStep = 3;
+    subTickCount = 2;
+  } else if (targetMonths <= 6)
+  {
+    monthStep = 6;
+    subTickCount = 5;
+  } else
+  {
+    // years in steps of 1, 2 or 5 times a power of ten:
+    const double targetYears = targetMonths/12.0;
+    const double magnitudeFactor = qPow(10.0, qFloor(qLn(targetYears)/qLn(10.0)));
+    const double mantissa = targetYears/magnitudeFactor;
+    const int yearStep = qMax(1, qRound((mantissa <= 1 ? 1 : (mantissa <= 2 ? 2 : (mantissa <= 5 ? 5 : 10)))*magnitudeFactor));
+    monthStep = 12*yearStep;
+    subTickCount = yearStep == 1 ? 3 : calculateAutoSubTickCount(yearStep);
+  }
+  mTickStep = monthStep*30.436875*day;
+  if (mAutoSubTicks)
+    mSubTickCount = subTickCount;
+  
+  // months are counted from January of year 0, ticks start at the step boundary at or before lower:
+  const QDate lowerDate = QDate::fromJulianDay(qFloor(lower/day)+epochJulianDay);
+  qint64 month = lowerDate.year()*12+lowerDate.month()-1;
+  month -= ((month%monthStep)+monthStep)%monthStep;
+  mTickVector.clear();
+  while (true)
+  {
+    const qint64 year = month >= 0 ? month/12 : (month-11)/12;
+    const QDate first(int(year), int(month-year*12)+1, 1);
+    if (!first.isValid())
+      break;
+    const double tick = (first.toJulianDay()-epochJulianDay)*day;
+    mTickVector.append(tick-utcOffset);
+    if (tick >= upper)
+      break;
+    month += monthStep;
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns the inputs of \ref setupTickVectors in their current state, used to decide whether the
+  memoized tick and tick label vectors are still valid.
+  
+  \see sameTicks, sameTickLabels
+*/
+QCPAxis::TickCacheKey QCPAxis::tickCacheKey() const
+{
+  TickCacheKey key;
+  key.range = mRange;
+  key.scaleType = mScaleType;
+  key.scaleLogBase = mScaleLogBase;
+  key.autoTickStep = mAutoTickStep;
+  key.autoSubTicks = mAutoSubTicks;
+  key.tickStep = mTickStep;
+  key.autoTickCount = mAutoTickCount;
+  key.subTickCount = mSubTickCount;
+  key.labelType = mTickLabelType;
+  key.dateTimeFormat = mDateTimeFormat;
+  key.dateTimeSpec = mDateTimeSpec;
+  key.calendarTicks = mCalendarTicks;
+  key.numberPrecision = mNumberPrecision;
+  key.numberFormatChar = mNumberFormatChar.toLatin1();
+  key.locale = mParentPlot ? mParentPlot->locale() : QLocale();
+  return key;
+}
+
+/*! \internal
+  
+  Returns whether the keys \a a and \a b lead to the same tick and sub tick vectors. The tick step
+  and sub tick count only matter if they are set manually, otherwise they are results of \ref
+  generateAutoTicks.
+*/
+bool QCPAxis::sameTicks(const TickCacheKey &a, const TickCacheKey &b) const
+{
+  return a.range.lower == b.range.lower && a.range.upper == b.range.upper &&
+      a.scaleType == b.scaleType &&
+      (a.scaleType == stLinear || a.scaleLogBase == b.scaleLogBase) &&
+      a.autoTickStep == b.autoTickStep && a.autoSubTicks == b.autoSubTicks &&
+      (a.autoTickStep ? a.autoTickCount == b.autoTickCount : a.tickStep == b.tickStep) &&
+      (a.autoSubTicks || a.subTickCount == b.subTickCount) &&
+      a.calendarTicks == b.calendarTicks &&
+      (!a.calendarTicks || (a.labelType == b.labelType && a.dateTimeSpec == b.dateTimeSpec));
+}
+
+/*! \internal
+  
+  Returns whether the keys \a a and \a b format a tick coordinate to the same tick label.
+*/
+bool QCPAxis::sameTickLabels(const TickCacheKey &a, const TickCacheKey &b) const
+{
+  if (a.labelType != b.labelType || a.locale != b.locale)
+    return false;
+  if (a.labelType == ltNumber)
+    return a.numberFormatChar == b.numberFormatChar && a.numberPrecision == b.numberPrecision;
+  else
+    return a.dateTimeFormat == b.dateTimeFormat && a.dateTimeSpec == b.dateTimeSpec;
+}
+
+/*! \internal
+  
+  Formats the tick coordinate \a tick according to the current tick label type, number format and
+  date time format, using the locale of the parent plot.
+*/
+QString QCPAxis::formatTickLabel(double tick) const
+{
+  if (mTickLabelType == ltNumber)
+  {
+    return mParentPlot->locale().toString(tick, mNumberFormatChar.toLatin1(), mNumberPrecision);
+  } else // mTickLabelType == ltDateTime
+  {
+#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0) // use fromMSecsSinceEpoch function if available, to gain sub-second accuracy on tick labels (e.g. for format "hh:mm:ss:zzz")
+    return mParentPlot->locale().toString(QDateTime::fromTime_t(tick).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
+#else
+    return mParentPlot->locale().toString(QDateTime::fromMSecsSinceEpoch(tick*1000).toTimeSpec(mDateTimeSpec), mDateTimeFormat);
+#endif
+  }
+}
+
 /*! \internal
   
   If \ref setAutoTicks is set to true, this function is called by \ref setupTickVectors to
@@ -5608,6 +6236,8 @@ void QCPAxis::generateAutoTicks()
 {
   if (mScaleType == stLinear)
   {
+    if (mCalendarTicks && mAutoTickStep && mTickLabelType == ltDateTime && generateCalendarTicks())
+      return;
     if (mAutoTickStep)
     {
       // Generate tick positions according to linear scaling:
@@ -6051,13 +6681,13 @@ QCP::Interaction QCPAxis::selectionCategory() const
   This is a private class and not part of the public QCustomPlot interface.
   
   It is used by QCPAxis to do the low-level drawing of axis backbone, tick marks, tick labels and
-  axis label. It also buffers the labels to reduce replot times. The parameters are configured by
-  directly accessing the public member variables.
+  axis label. The tick labels are buffered in the text atlas of the parent plot (\ref
+  QCustomPlot::textAtlas) to reduce replot times. The parameters are configured by directly
+  accessing the public member variables.
 */
 
 /*!
-  Constructs a QCPAxisPainterPrivate instance. Make sure to not create a new instance on every
-  redraw, to utilize the caching mechanisms.
+  Constructs a QCPAxisPainterPrivate instance.
 */
 QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   type(QCPAxis::atLeft),
@@ -6079,8 +6709,7 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   offset(0),
   abbreviateDecimalPowers(false),
   reversedEndings(false),
-  mParentPlot(parentPlot),
-  mLabelCache(16) // cache at most 16 (tick) labels
+  mParentPlot(parentPlot)
 {
 }
 
@@ -6097,12 +6726,7 @@ QCPAxisPainterPrivate::~QCPAxisPainterPrivate()
 */
 void QCPAxisPainterPrivate::draw(QCPPainter *painter)
 {
-  QByteArray newHash = generateLabelParameterHash();
-  if (newHash != mLabelParameterHash)
-  {
-    mLabelCache.clear();
-    mLabelParameterHash = newHash;
-  }
+  mLabelParameterHash = generateLabelParameterHash();
   
   QPoint origin;
   switch (type)
@@ -6323,38 +6947,26 @@ int QCPAxisPainterPrivate::size() const
 
 /*! \internal
   
-  Clears the internal label cache. Upon the next \ref draw, all labels will be created new. This
-  method is called automatically in \ref draw, if any parameters have changed that invalidate the
-  cached labels, such as font, color, etc.
-*/
-void QCPAxisPainterPrivate::clearCache()
-{
-  mLabelCache.clear();
-}
-
-/*! \internal
-  
-  Returns a hash that allows uniquely identifying whether the label parameters have changed such
-  that the cached labels must be refreshed (\ref clearCache). It is used in \ref draw. If the
-  return value of this method hasn't changed since the last redraw, the respective label parameters
-  haven't changed and cached labels may be used.
+  Returns the style part of the text atlas keys for the tick labels of this axis, i.e. all
+  parameters that affect how a tick label text is rendered to its pixmap (font, color, rotation and
+  the typesetting of powers). The tick label side and the axis type only affect where the pixmap is
+  placed, so axes differing only in those share their cached tick labels.
 */
 QByteArray QCPAxisPainterPrivate::generateLabelParameterHash() const
 {
-  QByteArray result;
-  result.append(QByteArray::number(tickLabelRotation));
-  result.append(QByteArray::number((int)tickLabelSide));
+  QByteArray result = QCPTextAtlas::styleKey(tickLabelFont, tickLabelColor, tickLabelRotation);
   result.append(QByteArray::number((int)substituteExponent));
   result.append(QByteArray::number((int)numberMultiplyCross));
-  result.append(tickLabelColor.name().toLatin1()+QByteArray::number(tickLabelColor.alpha(), 16));
-  result.append(tickLabelFont.toString().toLatin1());
+  result.append(QByteArray::number((int)abbreviateDecimalPowers));
+  result.append('\n');
   return result;
 }
 
 /*! \internal
   
-  Draws a single tick label with the provided \a painter, utilizing the internal label cache to
-  significantly speed up drawing of labels that were drawn in previous calls. The tick label is
+  Draws a single tick label with the provided \a painter, utilizing the text atlas of the parent
+  plot to significantly speed up drawing of labels that were drawn in previous calls or by other
+  axes. The tick label is
   always bound to an axis, the distance to the axis is controllable via \a distanceToAxis in
   pixels. The pixel position in the axis direction is passed in the \a position parameter. Hence
   for the bottom axis, \a position would indicate the horizontal pixel position (not coordinate),
@@ -6385,33 +6997,42 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
   }
   if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching)) // label caching enabled
   {
-    CachedLabel *cachedLabel = mLabelCache.take(text); // attempt to get label from cache
-    if (!cachedLabel)  // no cached label existed, create it
+    QCPTextAtlas *atlas = mParentPlot->textAtlas();
+    const QByteArray key = mLabelParameterHash + text.toUtf8();
+    const QCPTextAtlas::Entry *cachedLabel = atlas->find(key); // attempt to get label from atlas
+    if (!cachedLabel) // no cached label existed, create it
     {
-      cachedLabel = new CachedLabel;
       TickLabelData labelData = getTickLabelData(painter->font(), text);
-      cachedLabel->offset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
-      cachedLabel->pixmap = QPixmap(labelData.rotatedTotalBounds.size());
-      cachedLabel->pixmap.fill(Qt::transparent);
-      QCPPainter cachePainter(&cachedLabel->pixmap);
-      cachePainter.setPen(painter->pen());
-      drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
+      QCPTextAtlas::Entry entry;
+      entry.origin = -labelData.rotatedTotalBounds.topLeft();
+      entry.textSize = labelData.totalBounds.size();
+      entry.pixmap = QPixmap(labelData.rotatedTotalBounds.size());
+      entry.pixmap.fill(Qt::transparent);
+      {
+        QCPPainter cachePainter(&entry.pixmap);
+        cachePainter.setPen(painter->pen());
+        drawTickLabel(&cachePainter, entry.origin.x(), entry.origin.y(), labelData);
+      }
+      cachedLabel = atlas->insert(key, entry);
     }
+    // the offset depends on axis type and tick label side, which aren't part of the key, but only on the size of the unrotated label:
+    TickLabelData offsetData;
+    offsetData.totalBounds = QRect(QPoint(0, 0), cachedLabel->textSize);
+    QPointF labelOffset = getTickLabelDrawOffset(offsetData)-cachedLabel->origin;
     // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
     bool labelClippedByBorder = false;
     if (tickLabelSide == QCPAxis::lsOutside)
     {
       if (QCPAxis::orientation(type) == Qt::Horizontal)
-        labelClippedByBorder = labelAnchor.x()+cachedLabel->offset.x()+cachedLabel->pixmap.width() > viewportRect.right() || labelAnchor.x()+cachedLabel->offset.x() < viewportRect.left();
+        labelClippedByBorder = labelAnchor.x()+labelOffset.x()+cachedLabel->pixmap.width() > viewportRect.right() || labelAnchor.x()+labelOffset.x() < viewportRect.left();
       else
-        labelClippedByBorder = labelAnchor.y()+cachedLabel->offset.y()+cachedLabel->pixmap.height() > viewportRect.bottom() || labelAnchor.y()+cachedLabel->offset.y() < viewportRect.top();
+        labelClippedByBorder = labelAnchor.y()+labelOffset.y()+cachedLabel->pixmap.height() > viewportRect.bottom() || labelAnchor.y()+labelOffset.y() < viewportRect.top();
     }
     if (!labelClippedByBorder)
     {
-      painter->drawPixmap(labelAnchor+cachedLabel->offset, cachedLabel->pixmap);
+      painter->drawPixmap(labelAnchor+labelOffset, cachedLabel->pixmap);
       finalSize = cachedLabel->pixmap.size();
     }
-    mLabelCache.insert(text, cachedLabel); // return label to cache or insert for the first time if newly created
   } else // label caching disabled, draw text directly on surface:
   {
     TickLabelData labelData = getTickLabelData(painter->font(), text);
@@ -6668,9 +7289,11 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  const QCPTextAtlas::Entry *cachedLabel = 0;
+  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels)) // label caching enabled, check whether label is in the atlas
+    cachedLabel = mParentPlot->textAtlas()->peek(generateLabelParameterHash() + text.toUtf8());
+  if (cachedLabel)
   {
-    const CachedLabel *cachedLabel = mLabelCache.object(text);
     finalSize = cachedLabel->pixmap.size();
   } else // label caching disabled or no label with this text cached:
   {
@@ -6865,6 +7488,12 @@ QCPAbstractPlottable::QCPAbstractPlottable(QCPAxis *keyAxis, QCPAxis *valueAxis)
 void QCPAbstractPlottable::setName(const QString &name)
 {
   mName = name;
+  // the legend item's size depends on the name. Items in additional legends must be notified by the user:
+  if (mParentPlot && mParentPlot->legend)
+  {
+    if (QCPPlottableLegendItem *lip = mParentPlot->legend->itemWithPlottable(this))
+      lip->invalidateSizeHints();
+  }
 }
 
 /*!
@@ -7629,7 +8258,9 @@ QCPItemPosition::QCPItemPosition(QCustomPlot *parentPlot, QCPAbstractItem *paren
   mKey(0),
   mValue(0),
   mParentAnchorX(0),
-  mParentAnchorY(0)
+  mParentAnchorY(0),
+  mCachedPixelPointGeneration(0),
+  mPixelPointCached(false)
 {
 }
 
@@ -7716,6 +8347,7 @@ void QCPItemPosition::setTypeX(QCPItemPosition::PositionType type)
       pixel = pixelPoint();
     
     mPositionTypeX = type;
+    mParentPlot->invalidateItemPositions();
     
     if (retainPixelPosition)
       setPixelPoint(pixel);
@@ -7746,6 +8378,7 @@ void QCPItemPosition::setTypeY(QCPItemPosition::PositionType type)
       pixel = pixelPoint();
     
     mPositionTypeY = type;
+    mParentPlot->invalidateItemPositions();
     
     if (retainPixelPosition)
       setPixelPoint(pixel);
@@ -7834,6 +8467,7 @@ bool QCPItemPosition::setParentAnchorX(QCPItemAnchor *parentAnchor, bool keepPix
   if (parentAnchor)
     parentAnchor->addChildX(this);
   mParentAnchorX = parentAnchor;
+  mParentPlot->invalidateItemPositions();
   // restore pixel position under new parent:
   if (keepPixelPosition)
     setPixelPoint(pixelP);
@@ -7899,6 +8533,7 @@ bool QCPItemPosition::setParentAnchorY(QCPItemAnchor *parentAnchor, bool keepPix
   if (parentAnchor)
     parentAnchor->addChildY(this);
   mParentAnchorY = parentAnchor;
+  mParentPlot->invalidateItemPositions();
   // restore pixel position under new parent:
   if (keepPixelPosition)
     setPixelPoint(pixelP);
@@ -7926,8 +8561,13 @@ bool QCPItemPosition::setParentAnchorY(QCPItemAnchor *parentAnchor, bool keepPix
 */
 void QCPItemPosition::setCoords(double key, double value)
 {
-  mKey = key;
-  mValue = value;
+  // items like QCPItemTracer set their coordinates on every draw, only changed coordinates invalidate the memoized pixel positions:
+  if (mKey != key || mValue != value)
+  {
+    mKey = key;
+    mValue = value;
+    mParentPlot->invalidateItemPositions();
+  }
 }
 
 /*! \overload
@@ -7943,11 +8583,20 @@ void QCPItemPosition::setCoords(const QPointF &pos)
 /*!
   Returns the final absolute pixel position of the QCPItemPosition on the QCustomPlot surface. It
   includes all effects of type (\ref setType) and possible parent anchors (\ref setParentAnchor).
+  
+  The result is memoized until the parent plot reports that axis ranges, the layout or any item
+  position changed, so chains of anchored items are only resolved once per replot, no matter how
+  often the items call this function in their draw and selectTest methods. Positions whose parent
+  anchor isn't itself a QCPItemPosition are resolved on every call, because such anchors depend on
+  arbitrary item properties.
 
   \see setPixelPoint
 */
 QPointF QCPItemPosition::pixelPoint() const
 {
+  if (mPixelPointCached && mCachedPixelPointGeneration == mParentPlot->mItemPositionGeneration)
+    return mCachedPixelPoint;
+  
   QPointF result;
   
   // determine X:
@@ -8038,9 +8687,31 @@ QPointF QCPItemPosition::pixelPoint() const
     }
   }
   
+  mCachedPixelPoint = result;
+  mCachedPixelPointGeneration = mParentPlot->mItemPositionGeneration;
+  mPixelPointCached = isCachedParent(mParentAnchorX) && isCachedParent(mParentAnchorY);
   return result;
 }
 
+/*! \internal
+  
+  Returns whether the pixel position of \a parentAnchor is memoized as well, i.e. whether the
+  memoized pixel position of a child can't be outdated by the parent without the parent plot
+  noticing. That is the case if there is no parent anchor, or if it's a QCPItemPosition which
+  itself has memoized parents. Plain anchors (e.g. QCPItemText::bottomLeft) are computed by their
+  item from properties that don't invalidate the memoized positions.
+  
+  Must be called after the pixel position of \a parentAnchor was determined in the current
+  generation.
+*/
+bool QCPItemPosition::isCachedParent(QCPItemAnchor *parentAnchor) const
+{
+  if (!parentAnchor)
+    return true;
+  QCPItemPosition *parentPosition = parentAnchor->toQCPItemPosition();
+  return parentPosition && parentPosition->mPixelPointCached && parentPosition->mCachedPixelPointGeneration == mParentPlot->mItemPositionGeneration;
+}
+
 /*!
   When \ref setType is \ref ptPlotCoords, this function may be used to specify the axes the
   coordinates set with \ref setCoords relate to. By default they are set to the initial xAxis and
@@ -8050,6 +8721,7 @@ void QCPItemPosition::setAxes(QCPAxis *keyAxis, QCPAxis *valueAxis)
 {
   mKeyAxis = keyAxis;
   mValueAxis = valueAxis;
+  mParentPlot->invalidateItemPositions();
 }
 
 /*!
@@ -8060,6 +8732,7 @@ void QCPItemPosition::setAxes(QCPAxis *keyAxis, QCPAxis *valueAxis)
 void QCPItemPosition::setAxisRect(QCPAxisRect *axisRect)
 {
   mAxisRect = axisRect;
+  mParentPlot->invalidateItemPositions();
 }
 
 /*!
@@ -8745,6 +9418,13 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   one cell with the main QCPAxisRect inside.
 */
 
+/*! \fn QCPTextAtlas *QCustomPlot::textAtlas() const
+  
+  Returns the text atlas that caches the rendered axis tick labels, item texts and legend texts of
+  this plot (if \ref QCP::phCacheLabels is set). Its memory limit can be adjusted with \ref
+  QCPTextAtlas::setMemoryLimit, and its hit and miss counters show how effective the cache is.
+*/
+
 /* end of documentation of inline functions */
 /* start of documentation of signals */
 
@@ -9034,9 +9714,11 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mCurrentLayer(0),
   mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
   mMultiSelectModifier(Qt::ControlModifier),
+  mTextAtlas(new QCPTextAtlas),
   mPaintBuffer(size()),
   mMouseEventElement(0),
-  mReplotting(false)
+  mReplotting(false),
+  mItemPositionGeneration(0)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
@@ -9100,6 +9782,9 @@ QCustomPlot::~QCustomPlot()
   mCurrentLayer = 0;
   qDeleteAll(mLayers); // don't use removeLayer, because it would prevent the last layer to be removed
   mLayers.clear();
+  
+  delete mTextAtlas;
+  mTextAtlas = 0;
 }
 
 /*!
@@ -9364,6 +10049,7 @@ void QCustomPlot::setViewport(const QRect &rect)
   mViewport = rect;
   if (mPlotLayout)
     mPlotLayout->setOuterRect(mViewport);
+  invalidateItemPositions();
 }
 
 /*!
@@ -9537,6 +10223,9 @@ bool QCustomPlot::removePlottable(QCPAbstractPlottable *plottable)
   // special handling for QCPGraphs to maintain the simple graph interface:
   if (QCPGraph *graph = qobject_cast<QCPGraph*>(plottable))
     mGraphs.removeOne(graph);
+  // an axis rect that is range dragged with QCP::phShiftDrag may have buffered the plottable, rebuild its buffers with the next replot:
+  if (mShiftDragAxisRect)
+    mShiftDragAxisRect.data()->clearDragBuffers();
   // remove plottable:
   delete plottable;
   mPlottables.removeOne(plottable);
@@ -10877,6 +11566,12 @@ void QCustomPlot::draw(QCPPainter *painter)
   mPlotLayout->update(QCPLayoutElement::upPreparation);
   mPlotLayout->update(QCPLayoutElement::upMargins);
   mPlotLayout->update(QCPLayoutElement::upLayout);
+  invalidateItemPositions(); // the axis rects may have moved or changed size
+  
+  // an axis rect that is range dragged with QCP::phShiftDrag shifts its buffered plottables now that its rect is known:
+  QCPAxisRect *shiftDragAxisRect = painter->device() == &mPaintBuffer ? mShiftDragAxisRect.data() : 0;
+  if (shiftDragAxisRect)
+    shiftDragAxisRect->updateDragBuffers();
   
   // draw viewport background pixmap:
   drawBackground(painter);
@@ -10884,17 +11579,31 @@ void QCustomPlot::draw(QCPPainter *painter)
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   foreach (QCPLayer *layer, mLayers)
   {
+    QCPLayerable *batchStart = 0; // first layerable drawn with the currently saved painter setup
+    QRect batchClip;
     foreach (QCPLayerable *child, layer->children())
     {
-      if (child->realVisibility())
+      if (!child->realVisibility())
+        continue;
+      QRect clip = child->clipRect();
+      QRectF bounds = child->pixelBounds();
+      if (bounds.isValid() && !bounds.intersects(clip))
+        continue; // nothing of it would be visible, e.g. an item outside its axis rect
+      if (!batchStart || clip != batchClip || !batchStart->batchableWith(child))
       {
+        if (batchStart)
+          painter->restore();
         painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
+        painter->setClipRect(clip.translated(0, -1));
         child->applyDefaultAntialiasingHint(painter);
-        child->draw(painter);
-        painter->restore();
+        batchStart = child;
+        batchClip = clip;
       }
+      if (!shiftDragAxisRect || !shiftDragAxisRect->drawDragBuffer(painter, child))
+        child->draw(painter);
     }
+    if (batchStart)
+      painter->restore();
   }
   
   /* Debug code to draw all layout element rects
@@ -10948,6 +11657,18 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
   }
 }
 
+/*! \internal
+  
+  Discards the pixel positions that QCPItemPosition::pixelPoint has memoized. This is called
+  whenever the mapping from item coordinates to pixels may have changed: when an axis range, scale
+  type or direction changes, when the viewport changes, after the layout was updated in \ref draw,
+  and when any item position changes its coordinates, type, axes or parent anchors.
+*/
+void QCustomPlot::invalidateItemPositions()
+{
+  ++mItemPositionGeneration;
+}
+
 
 /*! \internal
   
@@ -10964,6 +11685,7 @@ void QCustomPlot::axisRemoved(QCPAxis *axis)
     yAxis = 0;
   if (yAxis2 == axis)
     yAxis2 = 0;
+  invalidateItemPositions();
   
   // Note: No need to take care of range drag axes and range zoom axes, because they are stored in smart pointers
 }
@@ -11014,6 +11736,11 @@ QCPLayerable *QCustomPlot::layerableAt(const QPointF &pos, bool onlySelectable,
     {
       if (!layerables.at(i)->realVisibility())
         continue;
+      // layerables that are clipped away entirely or farther than the tolerance from pos can't be hit:
+      QRectF bounds = layerables.at(i)->pixelBounds();
+      if (bounds.isValid() && (!bounds.intersects(layerables.at(i)->clipRect()) ||
+                               !bounds.adjusted(-mSelectionTolerance, -mSelectionTolerance, mSelectionTolerance, mSelectionTolerance).contains(pos)))
+        continue;
       QVariant details;
       double dist = layerables.at(i)->selectTest(pos, onlySelectable, &details);
       if (dist >= 0 && dist < minimumDistance)
@@ -11733,7 +12460,8 @@ QCPAxisRect::QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes) :
   mRangeZoom(Qt::Horizontal|Qt::Vertical),
   mRangeZoomFactorHorz(0.85),
   mRangeZoomFactorVert(0.85),
-  mDragging(false)
+  mDragging(false),
+  mDragBuffersValid(false)
 {
   mInsetLayout->initializeParentPlot(mParentPlot);
   mInsetLayout->setParentLayerable(this);
@@ -12448,6 +13176,160 @@ void QCPAxisRect::updateAxesOffset(QCPAxis::AxisType type)
   }
 }
 
+/*! \internal
+  
+  Called by QCustomPlot::draw after the layout update, while this axis rect is range dragged with
+  the \ref QCP::phShiftDrag plotting hint.
+  
+  The plottables that live on the range drag axes are drawn into one transparent buffer per layer.
+  As long as the drag only translates the ranges, the buffers are scrolled by the pixel distance the
+  range moved since they were drawn, and the plottables are drawn only into the strips that were
+  exposed by the scroll. Zooming, resizing, reversed ranges or logarithmic axes draw the buffers
+  anew.
+  
+  The content moves by the rounded total distance since the buffers were drawn completely, so
+  rounding doesn't accumulate. Exposed strips may be up to half a pixel off from the shifted
+  content, which the full replot after the drag corrects (see \ref mouseReleaseEvent).
+  
+  \see drawDragBuffer
+*/
+void QCPAxisRect::updateDragBuffers()
+{
+  QCPAxis *horz = mRangeDragHorzAxis.data();
+  QCPAxis *vert = mRangeDragVertAxis.data();
+  if (!horz || !vert || horz->axisRect() != this || vert->axisRect() != this ||
+      horz->scaleType() != QCPAxis::stLinear || vert->scaleType() != QCPAxis::stLinear || mRect.isEmpty())
+  {
+    clearDragBuffers();
+    return;
+  }
+  
+  if (mDragBuffersValid)
+  {
+    // where the range bounds the buffers were drawn with are now, both move by the same distance unless the ranges were zoomed:
+    QPointF lowerShift = QPointF(horz->coordToPixel(mDragBufferHorzRange.lower), vert->coordToPixel(mDragBufferVertRange.lower))-mDragBufferLowerPixel;
+    QPointF upperShift = QPointF(horz->coordToPixel(mDragBufferHorzRange.upper), vert->coordToPixel(mDragBufferVertRange.upper))-mDragBufferUpperPixel;
+    if (mRect.size() == mDragBufferRect.size() && (lowerShift-upperShift).manhattanLength() < 0.5)
+    {
+      QPoint shift = lowerShift.toPoint();
+      // the buffers cover mRect, so a moved axis rect moves the content in the opposite direction:
+      QPoint scroll = shift-mDragBufferShift-(mRect.topLeft()-mDragBufferRect.topLeft());
+      if (!scroll.isNull())
+      {
+        QRegion exposed;
+        for (QMap<QCPLayerable*, QPixmap>::iterator it=mDragBuffers.begin(); it!=mDragBuffers.end(); ++it)
+          it.value().scroll(scroll.x(), scroll.y(), it.value().rect(), &exposed);
+        drawIntoDragBuffers(exposed.translated(mRect.topLeft()));
+      }
+      mDragBufferShift = shift;
+      mDragBufferRect = mRect;
+      return;
+    }
+  }
+  
+  // draw the buffers completely, one per layer that holds plottables of the range drag axes:
+  clearDragBuffers();
+  QList<QCPLayerable*> candidates;
+  foreach (QCPAbstractPlottable *plottable, plottables())
+  {
+    bool keyIsHorz = plottable->keyAxis()->orientation() == Qt::Horizontal;
+    QCPAxis *plottableHorz = keyIsHorz ? plottable->keyAxis() : plottable->valueAxis();
+    QCPAxis *plottableVert = keyIsHorz ? plottable->valueAxis() : plottable->keyAxis();
+    if (plottableHorz == horz && plottableVert == vert && plottable->realVisibility()) // clipped to this axis rect, like the buffers
+      candidates.append(plottable);
+  }
+  if (candidates.isEmpty())
+    return;
+  foreach (QCPLayer *layer, mParentPlot->mLayers)
+  {
+    bool firstOfLayer = true;
+    foreach (QCPLayerable *child, layer->children())
+    {
+      if (!candidates.contains(child))
+        continue;
+      if (firstOfLayer) // the buffer of a layer is drawn where its first buffered plottable would be drawn
+      {
+        QPixmap buffer(mRect.size());
+        buffer.fill(Qt::transparent);
+        mDragBuffers.insert(child, buffer);
+        firstOfLayer = false;
+      }
+      mDragBufferLayerables.append(child);
+    }
+  }
+  mDragBufferRect = mRect;
+  mDragBufferShift = QPoint(0, 0);
+  mDragBufferHorzRange = horz->range();
+  mDragBufferVertRange = vert->range();
+  mDragBufferLowerPixel = QPointF(horz->coordToPixel(mDragBufferHorzRange.lower), vert->coordToPixel(mDragBufferVertRange.lower));
+  mDragBufferUpperPixel = QPointF(horz->coordToPixel(mDragBufferHorzRange.upper), vert->coordToPixel(mDragBufferVertRange.upper));
+  mDragBuffersValid = true;
+  drawIntoDragBuffers(QRegion(mRect));
+}
+
+/*! \internal
+  
+  Discards the drag buffers, so plottables are drawn normally again.
+  
+  \see updateDragBuffers
+*/
+void QCPAxisRect::clearDragBuffers()
+{
+  mDragBuffersValid = false;
+  mDragBufferLayerables.clear();
+  mDragBuffers.clear();
+}
+
+/*! \internal
+  
+  Clears \a region (in plot coordinates) in the drag buffers and draws the buffered plottables into
+  it, each into the buffer of its layer.
+*/
+void QCPAxisRect::drawIntoDragBuffers(const QRegion &region)
+{
+  QCPPainter painter;
+  foreach (QCPLayerable *layerable, mDragBufferLayerables)
+  {
+    QMap<QCPLayerable*, QPixmap>::iterator it = mDragBuffers.find(layerable);
+    if (it != mDragBuffers.end()) // first plottable of the next layer, switch buffers
+    {
+      if (painter.isActive())
+        painter.end();
+      if (!painter.begin(&it.value()))
+        return;
+      painter.setRenderHint(QPainter::HighQualityAntialiasing);
+      painter.translate(-mRect.topLeft());
+      painter.setClipRegion(region);
+      painter.setCompositionMode(QPainter::CompositionMode_Source);
+      painter.fillRect(mRect, Qt::transparent);
+      painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    }
+    painter.save();
+    layerable->applyDefaultAntialiasingHint(&painter);
+    layerable->draw(&painter);
+    painter.restore();
+  }
+  if (painter.isActive())
+    painter.end();
+}
+
+/*! \internal
+  
+  Called by QCustomPlot::draw for every \a layerable while this axis rect is range dragged with
+  \ref QCP::phShiftDrag. Returns false if \a layerable isn't buffered and must be drawn normally.
+  Otherwise draws the drag buffer of the layer, if \a layerable is the first buffered plottable of
+  its layer, and returns true.
+*/
+bool QCPAxisRect::drawDragBuffer(QCPPainter *painter, QCPLayerable *layerable) const
+{
+  if (!mDragBuffersValid || !mDragBufferLayerables.contains(layerable))
+    return false;
+  QMap<QCPLayerable*, QPixmap>::const_iterator it = mDragBuffers.constFind(layerable);
+  if (it != mDragBuffers.constEnd())
+    painter->drawPixmap(mRect.topLeft(), it.value());
+  return true;
+}
+
 /* inherits documentation from base class */
 int QCPAxisRect::calculateAutoMargin(QCP::MarginSide side)
 {
@@ -12544,6 +13426,8 @@ void QCPAxisRect::mouseMoveEvent(QMouseEvent *event)
     {
       if (mParentPlot->noAntialiasingOnDrag())
         mParentPlot->setNotAntialiasedElements(QCP::aeAll);
+      if (mParentPlot->plottingHints().testFlag(QCP::phShiftDrag))
+        mParentPlot->mShiftDragAxisRect = this; // the replot shifts our drag buffers instead of drawing the plottables anew
       mParentPlot->replot();
     }
   }
@@ -12559,6 +13443,13 @@ void QCPAxisRect::mouseReleaseEvent(QMouseEvent *event)
     mParentPlot->setAntialiasedElements(mAADragBackup);
     mParentPlot->setNotAntialiasedElements(mNotAADragBackup);
   }
+  if (mParentPlot->mShiftDragAxisRect == this)
+  {
+    // replace the shifted drag buffers by a full quality replot:
+    mParentPlot->mShiftDragAxisRect = 0;
+    clearDragBuffers();
+    mParentPlot->replot();
+  }
 }
 
 /*! \internal
@@ -12666,6 +13557,7 @@ QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
 void QCPAbstractLegendItem::setFont(const QFont &font)
 {
   mFont = font;
+  invalidateSizeHints();
 }
 
 /*!
@@ -12687,6 +13579,8 @@ void QCPAbstractLegendItem::setTextColor(const QColor &color)
 void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  if (mSelected)
+    invalidateSizeHints();
 }
 
 /*!
@@ -12727,6 +13621,7 @@ void QCPAbstractLegendItem::setSelected(bool selected)
   if (mSelected != selected)
   {
     mSelected = selected;
+    invalidateSizeHints(); // the selected font may have a different size
     emit selectionChanged(mSelected);
   }
 }
@@ -12871,7 +13766,13 @@ void QCPPlottableLegendItem::draw(QCPPainter *painter)
   QRectF textRect = painter->fontMetrics().boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
   QRectF iconRect(mRect.topLeft(), iconSize);
   int textHeight = qMax(textRect.height(), iconSize.height());  // if text has smaller height than icon, center text vertically in icon height, else align tops
-  painter->drawText(mRect.x()+iconSize.width()+mParentLegend->iconTextPadding(), mRect.y(), textRect.width(), textHeight, Qt::TextDontClip, mPlottable->name());
+  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching))
+  {
+    // the text is top aligned in the rect above, so the pixmap of its bounding rect goes to the same top left corner:
+    const QCPTextAtlas::Entry *entry = mParentPlot->textAtlas()->textEntry(painter->font(), getTextColor(), mPlottable->name(), Qt::TextDontClip);
+    painter->drawPixmap(QPointF(mRect.x()+iconSize.width()+mParentLegend->iconTextPadding(), mRect.y()), entry->pixmap);
+  } else
+    painter->drawText(mRect.x()+iconSize.width()+mParentLegend->iconTextPadding(), mRect.y(), textRect.width(), textHeight, Qt::TextDontClip, mPlottable->name());
   // draw icon:
   painter->save();
   painter->setClipRect(iconRect, Qt::IntersectClip);
@@ -13060,6 +13961,7 @@ void QCPLegend::setTextColor(const QColor &color)
 void QCPLegend::setIconSize(const QSize &size)
 {
   mIconSize = size;
+  sizeConstraintsChanged(); // the size hints of the items depend on the icon size
 }
 
 /*! \overload
@@ -13078,6 +13980,7 @@ void QCPLegend::setIconSize(int width, int height)
 void QCPLegend::setIconTextPadding(int padding)
 {
   mIconTextPadding = padding;
+  sizeConstraintsChanged();
 }
 
 /*!
@@ -13554,6 +14457,7 @@ QCPPlotTitle::QCPPlotTitle(QCustomPlot *parentPlot, const QString &text) :
 void QCPPlotTitle::setText(const QString &text)
 {
   mText = text;
+  invalidateSizeHints();
 }
 
 /*!
@@ -13564,6 +14468,7 @@ void QCPPlotTitle::setText(const QString &text)
 void QCPPlotTitle::setFont(const QFont &font)
 {
   mFont = font;
+  invalidateSizeHints();
 }
 
 /*!
@@ -16824,6 +17729,7 @@ QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   
   setScatterStyle(QCPScatterStyle());
   setLineStyle(lsLine);
+  setAdaptiveSampling(true);
 }
 
 QCPCurve::~QCPCurve()
@@ -16921,6 +17827,25 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
   mLineStyle = style;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this curve. Like \ref
+  QCPGraph::setAdaptiveSampling, it can drastically improve replot performance of curves with many
+  points, without notably changing their appearance.
+  
+  Since a curve isn't a function of its key, its points can't be sampled per key pixel like a
+  graph's. Instead, the pixel coordinates of the curve line are simplified in one pass: points that
+  are less than half a pixel away from the last kept point are dropped, and so are points that lie
+  within half a pixel of the straight line through their neighbours. Points where the curve turns
+  around are always kept, so the extent of the curve is preserved. Scatters are only thinned out
+  where consecutive points fall onto the same pixel.
+  
+  By default, adaptive sampling is enabled.
+*/
+void QCPCurve::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   \see removeData
@@ -17078,6 +18003,14 @@ void QCPCurve::draw(QCPPainter *painter)
   // fill with curve data:
   getCurveData(lineData);
   
+  // simplify the line in pixel space, scatters are thinned out separately further down:
+  QVector<QPointF> *pointData = lineData;
+  if (mAdaptiveSampling)
+  {
+    lineData = new QVector<QPointF>;
+    getSampledLineData(pointData, lineData);
+  }
+  
   // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
   QCPCurveDataMap::const_iterator it;
@@ -17149,10 +18082,20 @@ void QCPCurve::draw(QCPPainter *painter)
   
   // draw scatters:
   if (!mScatterStyle.isNone())
-    drawScatterPlot(painter, lineData);
+  {
+    if (mAdaptiveSampling)
+    {
+      QVector<QPointF> scatterData;
+      getSampledScatterData(pointData, &scatterData);
+      drawScatterPlot(painter, &scatterData);
+    } else
+      drawScatterPlot(painter, pointData);
+  }
   
   // free allocated line data:
-  delete lineData;
+  if (lineData != pointData)
+    delete lineData;
+  delete pointData;
 }
 
 /* inherits documentation from base class */
@@ -17297,6 +18240,146 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   *lineData << trailingPoints;
 }
 
+/*! \internal
+  
+  Simplifies the pixel coordinates \a lineData as returned by \ref getCurveData and writes the
+  result to \a sampledData. This is the line part of adaptive sampling, see \ref
+  setAdaptiveSampling.
+  
+  The line is walked once, extending a run from the last kept point (the anchor) as long as the
+  straight segment from the anchor still passes within the tolerance of every point of the run.
+  That is tracked with a cone of directions from the anchor, which every new point narrows, so no
+  point is ever visited twice. A run ends with the last point that still fit into the cone. If the
+  curve turns back on itself along the run, the farthest point of the run is kept instead, so
+  extrema aren't cut off. NaN points (gaps in the line) are passed through unchanged.
+*/
+void QCPCurve::getSampledLineData(const QVector<QPointF> *lineData, QVector<QPointF> *sampledData) const
+{
+  const double tolerance = 0.5; // pixels
+  sampledData->reserve(qMin(lineData->size(), 4096));
+  
+  QPointF anchor, last, direction, extremum, coneLower, coneUpper;
+  bool hasAnchor = false, lastIsKept = true, hasDirection = false;
+  double extremumProjection = 0;
+  
+  int i = 0;
+  while (i < lineData->size())
+  {
+    const QPointF &point = lineData->at(i);
+    if (qIsNaN(point.x()) || qIsNaN(point.y()))
+    {
+      // close the current run and pass the gap on:
+      if (hasAnchor && !lastIsKept)
+        sampledData->append(last);
+      sampledData->append(point);
+      hasAnchor = false;
+      ++i;
+      continue;
+    }
+    if (!hasAnchor)
+    {
+      sampledData->append(point);
+      anchor = last = point;
+      hasAnchor = lastIsKept = true;
+      hasDirection = false;
+      ++i;
+      continue;
+    }
+    
+    QPointF delta = point-anchor;
+    double distance = qSqrt(delta.x()*delta.x() + delta.y()*delta.y());
+    if (distance <= tolerance) // sub-pixel step away from the anchor, invisible
+    {
+      last = point;
+      lastIsKept = false;
+      ++i;
+      continue;
+    }
+    
+    // half the opening angle of the cone of lines that pass within tolerance of this point, as sine and cosine:
+    QPointF unit = delta/distance;
+    double sine = tolerance/distance;
+    double cosine = qSqrt(1-sine*sine);
+    QPointF lower(unit.x()*cosine + unit.y()*sine, unit.y()*cosine - unit.x()*sine); // unit rotated clockwise
+    QPointF upper(unit.x()*cosine - unit.y()*sine, unit.y()*cosine + unit.x()*sine); // unit rotated counterclockwise
+    
+    if (!hasDirection)
+    {
+      direction = unit;
+      coneLower = lower;
+      coneUpper = upper;
+      extremum = point;
+      extremumProjection = distance;
+      hasDirection = true;
+      last = point;
+      lastIsKept = false;
+      ++i;
+      continue;
+    }
+    
+    double projection = delta.x()*direction.x() + delta.y()*direction.y();
+    bool insideCone = coneLower.x()*delta.y() - coneLower.y()*delta.x() >= 0 && delta.x()*coneUpper.y() - delta.y()*coneUpper.x() >= 0;
+    if (projection < extremumProjection-tolerance)
+    {
+      // turning back along the run, keep its farthest point and start a new run there:
+      sampledData->append(extremum);
+      anchor = last = extremum;
+      lastIsKept = true;
+      hasDirection = false;
+      continue; // the current point is handled again with the new anchor
+    } else if (!insideCone)
+    {
+      // the run can't be extended to this point, keep the end of the run and start a new one there:
+      sampledData->append(last);
+      anchor = last;
+      lastIsKept = true;
+      hasDirection = false;
+      continue; // the current point is handled again with the new anchor
+    }
+    
+    // narrow the cone to the lines that also pass within tolerance of this point:
+    if (coneLower.x()*lower.y() - coneLower.y()*lower.x() > 0)
+      coneLower = lower;
+    if (coneUpper.x()*upper.y() - coneUpper.y()*upper.x() < 0)
+      coneUpper = upper;
+    if (projection > extremumProjection)
+    {
+      extremum = point;
+      extremumProjection = projection;
+    }
+    last = point;
+    lastIsKept = false;
+    ++i;
+  }
+  if (hasAnchor && !lastIsKept)
+    sampledData->append(last);
+}
+
+/*! \internal
+  
+  Writes the points of \a pointData to \a sampledData, leaving out points that fall onto the same
+  pixel as the point kept before them. This is the scatter part of adaptive sampling, see \ref
+  setAdaptiveSampling.
+*/
+void QCPCurve::getSampledScatterData(const QVector<QPointF> *pointData, QVector<QPointF> *sampledData) const
+{
+  sampledData->reserve(qMin(pointData->size(), 4096));
+  QPoint lastPixel;
+  bool hasLast = false;
+  for (int i=0; i<pointData->size(); ++i)
+  {
+    const QPointF &point = pointData->at(i);
+    if (qIsNaN(point.x()) || qIsNaN(point.y()))
+      continue;
+    QPoint pixel(qFloor(point.x()), qFloor(point.y()));
+    if (hasLast && pixel == lastPixel)
+      continue;
+    sampledData->append(point);
+    lastPixel = pixel;
+    hasLast = true;
+  }
+}
+
 /*! \internal
   
   This function is part of the curve optimization algorithm of \ref getCurveData.
@@ -18782,6 +19865,22 @@ void QCPBars::draw(QCPPainter *painter)
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (mData->isEmpty()) return;
   
+  bool drawFill = mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0;
+  bool drawLine = mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0;
+  if (!drawFill && !drawLine) return;
+  
+  // All bars share one pen and brush, so they are collected into one path for the fills and one for
+  // the lines, and each path is drawn with a single call. Bars whose centers fall into the same pixel
+  // column (along the key axis) would only overdraw each other, so they are merged into one bar
+  // spanning their combined min/max extent:
+  bool keyHorizontal = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  QPainterPath fillPath, linePath;
+  fillPath.setFillRule(Qt::WindingFill);
+  QPolygonF columnBar; // first bar of the current pixel column
+  QRectF columnExtent; // bounding rect of all bars in the current pixel column
+  double columnPixel = 0;
+  int columnBars = 0;
+  
   QCPBarDataMap::const_iterator it, lower, upperEnd;
   getVisibleDataBounds(lower, upperEnd);
   for (it = lower; it != upperEnd; ++it)
@@ -18792,22 +19891,39 @@ void QCPBars::draw(QCPPainter *painter)
       qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "of drawn range invalid." << "Plottable name:" << name();
 #endif
     QPolygonF barPolygon = getBarPolygon(it.key(), it.value().value);
-    // draw bar fill:
-    if (mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0)
-    {
-      applyFillAntialiasingHint(painter);
-      painter->setPen(Qt::NoPen);
-      painter->setBrush(mainBrush());
-      painter->drawPolygon(barPolygon);
-    }
-    // draw bar line:
-    if (mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0)
+    QRectF barRect = barPolygon.boundingRect();
+    double pixel = qFloor(keyHorizontal ? barRect.center().x() : barRect.center().y());
+    if (columnBars > 0 && pixel == columnPixel)
     {
-      applyDefaultAntialiasingHint(painter);
-      painter->setPen(mainPen());
-      painter->setBrush(Qt::NoBrush);
-      painter->drawPolyline(barPolygon);
+      columnExtent = columnExtent.united(barRect);
+      ++columnBars;
+      continue;
     }
+    if (columnBars > 0)
+      addBarToPaths(fillPath, linePath, columnBar, columnExtent, columnBars > 1);
+    columnBar = barPolygon;
+    columnExtent = barRect;
+    columnPixel = pixel;
+    columnBars = 1;
+  }
+  if (columnBars > 0)
+    addBarToPaths(fillPath, linePath, columnBar, columnExtent, columnBars > 1);
+  
+  // draw bar fills:
+  if (drawFill)
+  {
+    applyFillAntialiasingHint(painter);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(mainBrush());
+    painter->drawPath(fillPath);
+  }
+  // draw bar lines:
+  if (drawLine)
+  {
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mainPen());
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(linePath);
   }
 }
 
@@ -18922,6 +20038,32 @@ QPolygonF QCPBars::getBarPolygon(double key, double value) const
   return result;
 }
 
+/*! \internal
+  
+  Called by \ref draw to append one bar to the batched \a fillPath and \a linePath. \a bar is the
+  bar polygon as returned by \ref getBarPolygon, \a extent its bounding rect.
+  
+  If \a merged is true, \a extent covers several bars that fall into the same pixel column and is
+  added as a closed rect, since the merged bar has no single base side to leave open. Otherwise the
+  line is the open polyline of \a bar, like a bar drawn on its own.
+  
+  Fills are added as rects, which all have the same orientation, so overlapping bars don't cancel
+  each other out under the winding fill rule.
+*/
+void QCPBars::addBarToPaths(QPainterPath &fillPath, QPainterPath &linePath, const QPolygonF &bar, const QRectF &extent, bool merged) const
+{
+  fillPath.addRect(extent.normalized());
+  if (merged)
+  {
+    linePath.addRect(extent.normalized());
+  } else if (!bar.isEmpty())
+  {
+    linePath.moveTo(bar.first());
+    for (int i=1; i<bar.size(); ++i)
+      linePath.lineTo(bar.at(i));
+  }
+}
+
 /*! \internal
   
   This function is used to determine the width of the bar at coordinate \a key, according to the
@@ -22211,7 +23353,9 @@ QCPItemText::QCPItemText(QCustomPlot *parentPlot) :
   bottomRight(createAnchor(QLatin1String("bottomRight"), aiBottomRight)),
   bottom(createAnchor(QLatin1String("bottom"), aiBottom)),
   bottomLeft(createAnchor(QLatin1String("bottomLeft"), aiBottomLeft)),
-  left(createAnchor(QLatin1String("left"), aiLeft))
+  left(createAnchor(QLatin1String("left"), aiLeft)),
+  mTextRectCached(false),
+  mTextRectSelected(false)
 {
   position->setCoords(0, 0);
   
@@ -22300,6 +23444,7 @@ void QCPItemText::setSelectedBrush(const QBrush &brush)
 void QCPItemText::setFont(const QFont &font)
 {
   mFont = font;
+  mTextRectCached = false;
 }
 
 /*!
@@ -22310,6 +23455,7 @@ void QCPItemText::setFont(const QFont &font)
 void QCPItemText::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  mTextRectCached = false;
 }
 
 /*!
@@ -22321,6 +23467,7 @@ void QCPItemText::setSelectedFont(const QFont &font)
 void QCPItemText::setText(const QString &text)
 {
   mText = text;
+  mTextRectCached = false;
 }
 
 /*!
@@ -22346,6 +23493,7 @@ void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 {
   mTextAlignment = alignment;
+  mTextRectCached = false;
 }
 
 /*!
@@ -22394,7 +23542,8 @@ double QCPItemText::selectTest(const QPointF &pos, bool onlySelectable, QVariant
 void QCPItemText::draw(QCPPainter *painter)
 {
   QPointF pos(position->pixelPoint());
-  QTransform transform = painter->transform();
+  const QTransform oldTransform = painter->transform();
+  QTransform transform = oldTransform;
   transform.translate(pos.x(), pos.y());
   if (!qFuzzyIsNull(mRotation))
     transform.rotate(mRotation);
@@ -22418,10 +23567,39 @@ void QCPItemText::draw(QCPPainter *painter)
     }
     painter->setBrush(Qt::NoBrush);
     painter->setPen(QPen(mainColor()));
-    painter->drawText(textRect, Qt::TextDontClip|mTextAlignment, mText);
+    // unrotated text on screen is blitted from the plot's text atlas, rotated or exported text is drawn directly:
+    if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching) &&
+        transform.type() <= QTransform::TxTranslate)
+    {
+      const QCPTextAtlas::Entry *entry = mParentPlot->textAtlas()->textEntry(painter->font(), mainColor(), mText, Qt::TextDontClip|mTextAlignment);
+      painter->drawPixmap(textRect.topLeft(), entry->pixmap);
+    } else
+      painter->drawText(textRect, Qt::TextDontClip|mTextAlignment, mText);
+    painter->setTransform(oldTransform); // leave the painter as found, so text items can be drawn in batches
   }
 }
 
+/* inherits documentation from base class */
+QRectF QCPItemText::pixelBounds()
+{
+  QPointF pos(position->pixelPoint());
+  QTransform transform;
+  transform.translate(pos.x(), pos.y());
+  if (!qFuzzyIsNull(mRotation))
+    transform.rotate(mRotation);
+  QRectF textBoxRect = cachedTextRect().adjusted(-mPadding.left(), -mPadding.top(), mPadding.right(), mPadding.bottom());
+  textBoxRect.moveTopLeft(getTextDrawPoint(QPointF(0, 0), textBoxRect, mPositionAlignment).toPoint());
+  double pad = mainPen().widthF()+1; // one more pixel for rounding and painter font metrics that differ slightly
+  return transform.mapRect(textBoxRect.adjusted(-pad, -pad, pad, pad));
+}
+
+/* inherits documentation from base class */
+bool QCPItemText::batchableWith(const QCPLayerable *other) const
+{
+  const QCPItemText *otherText = qobject_cast<const QCPItemText*>(other);
+  return otherText && otherText->mAntialiased == mAntialiased;
+}
+
 /* inherits documentation from base class */
 QPointF QCPItemText::anchorPixelPoint(int anchorId) const
 {
@@ -22431,8 +23609,7 @@ QPointF QCPItemText::anchorPixelPoint(int anchorId) const
   transform.translate(pos.x(), pos.y());
   if (!qFuzzyIsNull(mRotation))
     transform.rotate(mRotation);
-  QFontMetrics fontMetrics(mainFont());
-  QRect textRect = fontMetrics.boundingRect(0, 0, 0, 0, Qt::TextDontClip|mTextAlignment, mText);
+  QRect textRect = cachedTextRect();
   QRectF textBoxRect = textRect.adjusted(-mPadding.left(), -mPadding.top(), mPadding.right(), mPadding.bottom());
   QPointF textPos = getTextDrawPoint(QPointF(0, 0), textBoxRect, mPositionAlignment); // 0, 0 because the transform does the translation
   textBoxRect.moveTopLeft(textPos.toPoint());
@@ -22481,6 +23658,23 @@ QPointF QCPItemText::getTextDrawPoint(const QPointF &pos, const QRectF &rect, Qt
   return result;
 }
 
+/*! \internal
+  
+  Returns the unpadded text rect of the current \ref mainFont, as the draw function lays it out
+  around the origin. The font metrics are only asked again when text, font, text alignment or the
+  selection state changed, so hit tests, anchors and culling of many text items stay cheap.
+*/
+QRect QCPItemText::cachedTextRect() const
+{
+  if (!mTextRectCached || mTextRectSelected != mSelected)
+  {
+    mCachedTextRect = QFontMetrics(mainFont()).boundingRect(0, 0, 0, 0, Qt::TextDontClip|mTextAlignment, mText);
+    mTextRectSelected = mSelected;
+    mTextRectCached = true;
+  }
+  return mCachedTextRect;
+}
+
 /*! \internal
 
   Returns the font that should be used for drawing text. Returns mFont when the item is not selected
@@ -23234,6 +24428,24 @@ void QCPItemTracer::draw(QCPPainter *painter)
   }
 }
 
+/* inherits documentation from base class */
+QRectF QCPItemTracer::pixelBounds()
+{
+  if (mStyle == tsCrosshair)
+    return QRectF(); // spans the whole clip rect
+  updatePosition(); // a tracer on a graph only knows where it is after updating
+  QPointF center(position->pixelPoint());
+  double w = mSize/2.0+mainPen().widthF()+1;
+  return QRectF(center-QPointF(w, w), center+QPointF(w, w));
+}
+
+/* inherits documentation from base class */
+bool QCPItemTracer::batchableWith(const QCPLayerable *other) const
+{
+  const QCPItemTracer *otherTracer = qobject_cast<const QCPItemTracer*>(other);
+  return otherTracer && otherTracer->mAntialiased == mAntialiased;
+}
+
 /*!
   If the tracer is connected with a graph (\ref setGraph), this function updates the tracer's \a
   position to reside on the graph data, depending on the configured key (\ref setGraphKey).
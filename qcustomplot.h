@@ -141,7 +141,9 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                                               ///<                especially of the line segment joins. (Only relevant for solid line pens.)
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpHint.
                                               ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
-                    ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels, item texts and legend texts will be cached as pixmaps in the plot's \ref QCPTextAtlas, increasing replot performance.
+                    ,phShiftDrag      = 0x008 ///< <tt>0x008</tt> while an axis rect is range dragged, its plottables are shifted as pixmaps and only drawn in the newly exposed strips. A full replot follows
+                                              ///<                when the drag ends. Data changes during the drag only show in the exposed strips until then.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -305,6 +307,16 @@ protected:
   
   // non-property members:
   bool mPenDefined;
+  mutable QPixmap mSprite;
+  mutable QPen mSpritePen;
+  mutable QBrush mSpriteBrush;
+  mutable double mSpriteRatio;
+  mutable bool mSpriteAntialiased;
+  mutable double mSpriteOffset;
+  
+  // non-virtual methods:
+  bool updateSprite(QCPPainter *painter) const;
+  void drawShapeVectorized(QCPPainter *painter, double x, double y) const;
 };
 Q_DECLARE_TYPEINFO(QCPScatterStyle, Q_MOVABLE_TYPE);
 
@@ -362,6 +374,51 @@ protected:
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPPainter::PainterModes)
 
 
+class QCP_LIB_DECL QCPTextAtlas
+{
+public:
+  /*!
+    A text rendered to a pixmap. \a origin is the position of the text's reference point inside the
+    pixmap and \a textSize the size of the unrotated text.
+  */
+  struct Entry
+  {
+    QPixmap pixmap;
+    QPoint origin;
+    QSize textSize;
+  };
+  
+  explicit QCPTextAtlas(int memoryLimit=8*1024*1024);
+  
+  // getters:
+  int memoryLimit() const { return mCache.maxCost(); }
+  int memoryUsage() const { return mCache.totalCost(); }
+  int count() const { return mCache.count(); }
+  qint64 hits() const { return mHits; }
+  qint64 misses() const { return mMisses; }
+  
+  // setters:
+  void setMemoryLimit(int bytes);
+  
+  // non-virtual methods:
+  const Entry *find(const QByteArray &key);
+  const Entry *peek(const QByteArray &key) const;
+  const Entry *insert(const QByteArray &key, const Entry &entry);
+  const Entry *textEntry(const QFont &font, const QColor &color, const QString &text, int flags);
+  void clear();
+  void resetStatistics();
+  static QByteArray styleKey(const QFont &font, const QColor &color, double rotation);
+  
+protected:
+  QCache<QByteArray, Entry> mCache;
+  Entry mUncached;
+  qint64 mHits, mMisses;
+  
+private:
+  Q_DISABLE_COPY(QCPTextAtlas)
+};
+
+
 class QCP_LIB_DECL QCPLayer : public QObject
 {
   Q_OBJECT
@@ -455,6 +512,8 @@ protected:
   virtual QRect clipRect() const;
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const = 0;
   virtual void draw(QCPPainter *painter) = 0;
+  virtual QRectF pixelBounds();
+  virtual bool batchableWith(const QCPLayerable *other) const;
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
@@ -684,6 +743,9 @@ public:
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
   
+  // non-virtual methods:
+  void invalidateSizeHints();
+  
 protected:
   // property members:
   QCPLayout *mParentLayout;
@@ -741,9 +803,10 @@ public:
 protected:
   // introduced virtual methods:
   virtual void updateLayout();
+  virtual void invalidateLayoutCache();
   
   // non-virtual methods:
-  void sizeConstraintsChanged() const;
+  void sizeConstraintsChanged();
   void adoptElement(QCPLayoutElement *el);
   void releaseElement(QCPLayoutElement *el);
   QVector<int> getSectionSizes(QVector<int> maxSizes, QVector<int> minSizes, QVector<double> stretchFactors, int totalSize) const;
@@ -811,9 +874,20 @@ protected:
   QList<double> mRowStretchFactors;
   int mColumnSpacing, mRowSpacing;
   
+  // non-property members:
+  mutable bool mConstraintsCacheValid;
+  mutable QVector<int> mCachedMinColWidths, mCachedMinRowHeights, mCachedMaxColWidths, mCachedMaxRowHeights;
+  bool mSectionsCacheValid;
+  QSize mCachedSectionsSize;
+  QVector<int> mCachedColWidths, mCachedRowHeights;
+  
+  // reimplemented virtual methods:
+  virtual void invalidateLayoutCache();
+  
   // non-virtual methods:
   void getMinimumRowColSizes(QVector<int> *minColWidths, QVector<int> *minRowHeights) const;
   void getMaximumRowColSizes(QVector<int> *maxColWidths, QVector<int> *maxRowHeights) const;
+  void updateConstraintsCache() const;
   
 private:
   Q_DISABLE_COPY(QCPLayoutGrid)
@@ -1002,6 +1076,7 @@ class QCP_LIB_DECL QCPAxis : public QCPLayerable
   Q_PROPERTY(LabelSide tickLabelSide READ tickLabelSide WRITE setTickLabelSide)
   Q_PROPERTY(QString dateTimeFormat READ dateTimeFormat WRITE setDateTimeFormat)
   Q_PROPERTY(Qt::TimeSpec dateTimeSpec READ dateTimeSpec WRITE setDateTimeSpec)
+  Q_PROPERTY(bool calendarTicks READ calendarTicks WRITE setCalendarTicks)
   Q_PROPERTY(QString numberFormat READ numberFormat WRITE setNumberFormat)
   Q_PROPERTY(int numberPrecision READ numberPrecision WRITE setNumberPrecision)
   Q_PROPERTY(double tickStep READ tickStep WRITE setTickStep)
@@ -1110,6 +1185,7 @@ public:
   LabelSide tickLabelSide() const;
   QString dateTimeFormat() const { return mDateTimeFormat; }
   Qt::TimeSpec dateTimeSpec() const { return mDateTimeSpec; }
+  bool calendarTicks() const { return mCalendarTicks; }
   QString numberFormat() const;
   int numberPrecision() const { return mNumberPrecision; }
   double tickStep() const { return mTickStep; }
@@ -1166,6 +1242,7 @@ public:
   void setTickLabelSide(LabelSide side);
   void setDateTimeFormat(const QString &format);
   void setDateTimeSpec(const Qt::TimeSpec &timeSpec);
+  void setCalendarTicks(bool enabled);
   void setNumberFormat(const QString &formatCode);
   void setNumberPrecision(int precision);
   void setTickStep(double step);
@@ -1252,6 +1329,7 @@ protected:
   QColor mTickLabelColor, mSelectedTickLabelColor;
   QString mDateTimeFormat;
   Qt::TimeSpec mDateTimeSpec;
+  bool mCalendarTicks;
   int mNumberPrecision;
   QLatin1Char mNumberFormatChar;
   bool mNumberBeautifulPowers;
@@ -1279,6 +1357,26 @@ protected:
   QVector<double> mSubTickVector;
   bool mCachedMarginValid;
   int mCachedMargin;
+  // tick memoization, see setupTickVectors:
+  struct TickCacheKey
+  {
+    QCPRange range;
+    ScaleType scaleType;
+    double scaleLogBase;
+    bool autoTickStep, autoSubTicks;
+    double tickStep;
+    int autoTickCount, subTickCount;
+    LabelType labelType;
+    QString dateTimeFormat;
+    Qt::TimeSpec dateTimeSpec;
+    bool calendarTicks;
+    int numberPrecision;
+    char numberFormatChar;
+    QLocale locale;
+  };
+  bool mTickCacheValid;
+  TickCacheKey mTickCacheKey;
+  QMap<double, QString> mTickLabelCache;
   
   // introduced virtual methods:
   virtual void setupTickVectors();
@@ -1296,6 +1394,11 @@ protected:
   
   // non-virtual methods:
   void visibleTickBounds(int &lowIndex, int &highIndex) const;
+  bool generateCalendarTicks();
+  TickCacheKey tickCacheKey() const;
+  bool sameTicks(const TickCacheKey &a, const TickCacheKey &b) const;
+  bool sameTickLabels(const TickCacheKey &a, const TickCacheKey &b) const;
+  QString formatTickLabel(double tick) const;
   double baseLog(double value) const;
   double basePow(double value) const;
   QPen getBasePen() const;
@@ -1326,7 +1429,6 @@ public:
   
   virtual void draw(QCPPainter *painter);
   virtual int size() const;
-  void clearCache();
   
   QRect axisSelectionBox() const { return mAxisSelectionBox; }
   QRect tickLabelsSelectionBox() const { return mTickLabelsSelectionBox; }
@@ -1359,11 +1461,6 @@ public:
   QVector<QString> tickLabels;
   
 protected:
-  struct CachedLabel
-  {
-    QPointF offset;
-    QPixmap pixmap;
-  };
   struct TickLabelData
   {
     QString basePart, expPart;
@@ -1371,8 +1468,7 @@ protected:
     QFont baseFont, expFont;
   };
   QCustomPlot *mParentPlot;
-  QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
-  QCache<QString, CachedLabel> mLabelCache;
+  QByteArray mLabelParameterHash; // style part of the text atlas keys of the tick labels
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
   
   virtual QByteArray generateLabelParameterHash() const;
@@ -1595,9 +1691,17 @@ protected:
   double mKey, mValue;
   QCPItemAnchor *mParentAnchorX, *mParentAnchorY;
   
+  // non-property members:
+  mutable QPointF mCachedPixelPoint;
+  mutable quint64 mCachedPixelPointGeneration;
+  mutable bool mPixelPointCached;
+  
   // reimplemented virtual methods:
   virtual QCPItemPosition *toQCPItemPosition() { return this; }
   
+  // non-virtual methods:
+  bool isCachedParent(QCPItemAnchor *parentAnchor) const;
+  
 private:
   Q_DISABLE_COPY(QCPItemPosition)
   
@@ -1729,6 +1833,7 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  QCPTextAtlas *textAtlas() const { return mTextAtlas; }
 
   // setters:
   void setViewport(const QRect &rect);
@@ -1864,10 +1969,13 @@ protected:
   Qt::KeyboardModifier mMultiSelectModifier;
   
   // non-property members:
+  QCPTextAtlas *mTextAtlas;
   QPixmap mPaintBuffer;
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
+  quint64 mItemPositionGeneration;
+  QPointer<QCPAxisRect> mShiftDragAxisRect;
   
   // reimplemented virtual methods:
   virtual QSize minimumSizeHint() const;
@@ -1889,11 +1997,13 @@ protected:
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  void invalidateItemPositions();
   
   friend class QCPLegend;
   friend class QCPAxis;
   friend class QCPLayer;
   friend class QCPAxisRect;
+  friend class QCPItemPosition;
 };
 
 
@@ -2056,6 +2166,14 @@ protected:
   QPoint mDragStart;
   bool mDragging;
   QHash<QCPAxis::AxisType, QList<QCPAxis*> > mAxes;
+  // plottables shifted as pixmaps during range drag (QCP::phShiftDrag), see updateDragBuffers:
+  bool mDragBuffersValid;
+  QList<QCPLayerable*> mDragBufferLayerables;
+  QMap<QCPLayerable*, QPixmap> mDragBuffers;
+  QRect mDragBufferRect;
+  QPoint mDragBufferShift;
+  QCPRange mDragBufferHorzRange, mDragBufferVertRange;
+  QPointF mDragBufferLowerPixel, mDragBufferUpperPixel;
   
   // reimplemented virtual methods:
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const;
@@ -2070,6 +2188,10 @@ protected:
   // non-property methods:
   void drawBackground(QCPPainter *painter);
   void updateAxesOffset(QCPAxis::AxisType type);
+  void updateDragBuffers();
+  void clearDragBuffers();
+  void drawIntoDragBuffers(const QRegion &region);
+  bool drawDragBuffer(QCPPainter *painter, QCPLayerable *layerable) const;
   
 private:
   Q_DISABLE_COPY(QCPAxisRect)
@@ -2663,6 +2785,7 @@ class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
   /// \cond INCLUDE_QPROPERTIES
   Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
   Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   /*!
@@ -2680,6 +2803,7 @@ public:
   QCPCurveDataMap *data() const { return mData; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   LineStyle lineStyle() const { return mLineStyle; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QCPCurveDataMap *data, bool copy=false);
@@ -2687,6 +2811,7 @@ public:
   void setData(const QVector<double> &key, const QVector<double> &value);
   void setScatterStyle(const QCPScatterStyle &style);
   void setLineStyle(LineStyle style);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QCPCurveDataMap &dataMap);
@@ -2708,6 +2833,7 @@ protected:
   QCPCurveDataMap *mData;
   QCPScatterStyle mScatterStyle;
   LineStyle mLineStyle;
+  bool mAdaptiveSampling;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
@@ -2720,6 +2846,8 @@ protected:
   
   // non-virtual methods:
   void getCurveData(QVector<QPointF> *lineData) const;
+  void getSampledLineData(const QVector<QPointF> *lineData, QVector<QPointF> *sampledData) const;
+  void getSampledScatterData(const QVector<QPointF> *pointData, QVector<QPointF> *sampledData) const;
   int getRegion(double x, double y, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
   QPointF getOptimizedPoint(int prevRegion, double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
   QVector<QPointF> getOptimizedCornerPoints(int prevRegion, int currentRegion, double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
@@ -2898,6 +3026,7 @@ protected:
   // non-virtual methods:
   void getVisibleDataBounds(QCPBarDataMap::const_iterator &lower, QCPBarDataMap::const_iterator &upperEnd) const;
   QPolygonF getBarPolygon(double key, double value) const;
+  void addBarToPaths(QPainterPath &fillPath, QPainterPath &linePath, const QPolygonF &bar, const QRectF &extent, bool merged) const;
   void getPixelWidth(double key, double &lower, double &upper) const;
   double getStackedBaseValue(double key, bool positive) const;
   static void connectBars(QCPBars* lower, QCPBars* upper);
@@ -3497,12 +3626,19 @@ protected:
   double mRotation;
   QMargins mPadding;
   
+  // non-property members:
+  mutable QRect mCachedTextRect;
+  mutable bool mTextRectCached, mTextRectSelected;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
+  virtual QRectF pixelBounds();
+  virtual bool batchableWith(const QCPLayerable *other) const;
   virtual QPointF anchorPixelPoint(int anchorId) const;
   
   // non-virtual methods:
   QPointF getTextDrawPoint(const QPointF &pos, const QRectF &rect, Qt::Alignment positionAlignment) const;
+  QRect cachedTextRect() const;
   QFont mainFont() const;
   QColor mainColor() const;
   QPen mainPen() const;
@@ -3704,6 +3840,8 @@ protected:
 
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
+  virtual QRectF pixelBounds();
+  virtual bool batchableWith(const QCPLayerable *other) const;
 
   // non-virtual methods:
   QPen mainPen() const;
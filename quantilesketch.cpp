@@ -0,0 +1,141 @@
+#include "quantilesketch.h"
+#include <QPair>
+#include <qmath.h>
+#include <algorithm>
+
+QuantileSketch::QuantileSketch(int k) :
+    m_k(qMax(k, 8)),
+    m_count(0),
+    m_size(0),
+    m_maxSize(0),
+    m_seed(2463534242u)
+{
+    grow();
+}
+
+void QuantileSketch::clear()
+{
+    m_count = 0;
+    m_size = 0;
+    m_maxSize = 0;
+    m_levels.clear();
+    grow();
+}
+
+void QuantileSketch::add(double value)
+{
+    m_levels[0].append(value);
+    m_size++;
+    m_count++;
+
+    if(m_size >= m_maxSize)
+        compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    while(m_levels.size() < other.m_levels.size())
+        grow();
+
+    for(int level = 0; level < other.m_levels.size(); level++)
+        m_levels[level] += other.m_levels.at(level);
+
+    m_size += other.m_size;
+    m_count += other.m_count;
+
+    if(m_size >= m_maxSize)
+        compress();
+}
+
+double QuantileSketch::quantile(double fraction) const
+{
+    if(m_size == 0)
+        return 0;
+
+    //Every sample on level h stands for 2^h original values
+    QVector<QPair<double, qint64> > samples;
+    samples.reserve(m_size);
+    qint64 totalWeight = 0;
+
+    for(int level = 0; level < m_levels.size(); level++) {
+        qint64 weight = qint64(1) << level;
+
+        for(int i = 0; i < m_levels.at(level).size(); i++)
+            samples.append(qMakePair(m_levels.at(level).at(i), weight));
+
+        totalWeight += weight * m_levels.at(level).size();
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    qint64 rank = qint64(qBound(0.0, fraction, 1.0) * (totalWeight - 1));
+    qint64 cumulative = 0;
+    for(int i = 0; i < samples.size(); i++) {
+        cumulative += samples.at(i).second;
+        if(cumulative > rank)
+            return samples.at(i).first;
+    }
+
+    return samples.last().first;
+}
+
+int QuantileSketch::capacity(int level) const
+{
+    //Lower levels shrink geometrically, so the whole sketch stays within about 3k samples
+    int depth = m_levels.size() - level - 1;
+    return qMax(2, int(qCeil(m_k * qPow(2.0 / 3.0, depth))));
+}
+
+void QuantileSketch::grow()
+{
+    m_levels.append(QVector<double>());
+
+    m_maxSize = 0;
+    for(int level = 0; level < m_levels.size(); level++)
+        m_maxSize += capacity(level);
+}
+
+void QuantileSketch::compress()
+{
+    while(m_size >= m_maxSize) {
+        for(int level = 0; level < m_levels.size(); level++) {
+            if(m_levels.at(level).size() >= capacity(level)) {
+                if(level + 1 >= m_levels.size())
+                    grow();
+
+                compact(level);
+                break;
+            }
+        }
+    }
+}
+
+void QuantileSketch::compact(int level)
+{
+    QVector<double>& values = m_levels[level];
+    QVector<double>& next = m_levels[level + 1];
+
+    std::sort(values.begin(), values.end());
+
+    //xorshift32, picks whether the even or the odd samples are promoted
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    int offset = m_seed & 1;
+
+    //An odd leftover stays on this level so no weight is lost
+    int pairs = values.size() / 2;
+    double leftover = values.last();
+    bool hasLeftover = values.size() % 2 == 1;
+
+    for(int i = 0; i < pairs; i++)
+        next.append(values.at(2 * i + offset));
+
+    m_size -= values.size() - pairs;
+    values.clear();
+
+    if(hasLeftover) {
+        values.append(leftover);
+        m_size++;
+    }
+}
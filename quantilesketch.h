@@ -0,0 +1,36 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <QVector>
+
+//KLL quantile sketch. Keeps O(k) samples no matter how many values were added,
+//answers any quantile with rank error of roughly 1/k and can be merged with
+//other sketches. Values cannot be removed; rebuild the sketch instead.
+class QuantileSketch
+{
+public:
+    explicit QuantileSketch(int k = 200);
+
+    void clear();
+    void add(double value);
+    void merge(const QuantileSketch& other);
+
+    qint64 count() const { return m_count; }
+    int retained() const { return m_size; }
+    double quantile(double fraction) const;
+
+private:
+    int m_k;
+    qint64 m_count;
+    int m_size;
+    int m_maxSize;
+    quint32 m_seed;
+    QVector<QVector<double> > m_levels;
+
+    int capacity(int level) const;
+    void grow();
+    void compress();
+    void compact(int level);
+};
+
+#endif // QUANTILESKETCH_H
@@ -0,0 +1,111 @@
+#include "rangeaggregates.h"
+#include <limits>
+#include <QtGlobal>
+
+RangeAggregates::Result::Result() :
+    count(0),
+    won(0),
+    lost(0),
+    max(0),
+    min(0)
+{
+}
+
+void RangeAggregates::Result::merge(const Result& other)
+{
+    if(other.count == 0)
+        return;
+
+    if(count == 0) {
+        max = other.max;
+        min = other.min;
+    }
+    else {
+        max = qMax(max, other.max);
+        min = qMin(min, other.min);
+    }
+
+    count += other.count;
+    won += other.won;
+    lost += other.lost;
+    sum += other.sum;
+}
+
+RangeAggregates::RangeAggregates() :
+    m_size(0)
+{
+}
+
+void RangeAggregates::build(const QVector<double>& values)
+{
+    m_size = values.size();
+
+    //Prefix arrays have one extra leading zero so that range = p[last + 1] - p[first]
+    m_sums.resize(m_size + 1);
+    m_won.resize(m_size + 1);
+    m_sums[0] = ExactSum();
+    m_won[0] = 0;
+
+    for(int i = 0; i < m_size; i++) {
+        m_sums[i + 1] = m_sums.at(i) + ExactSum(values.at(i));
+        m_won[i + 1] = m_won[i] + (values.at(i) >= 0 ? 1 : 0);
+    }
+
+    //Leaves live in [m_size, 2 * m_size), parents are filled bottom-up
+    m_maxTree.resize(2 * m_size);
+    m_minTree.resize(2 * m_size);
+
+    for(int i = 0; i < m_size; i++) {
+        m_maxTree[m_size + i] = values.at(i);
+        m_minTree[m_size + i] = values.at(i);
+    }
+    for(int i = m_size - 1; i > 0; i--) {
+        m_maxTree[i] = qMax(m_maxTree.at(2 * i), m_maxTree.at(2 * i + 1));
+        m_minTree[i] = qMin(m_minTree.at(2 * i), m_minTree.at(2 * i + 1));
+    }
+}
+
+void RangeAggregates::clear()
+{
+    m_size = 0;
+    m_sums.clear();
+    m_won.clear();
+    m_maxTree.clear();
+    m_minTree.clear();
+}
+
+RangeAggregates::Result RangeAggregates::query(int first, int last) const
+{
+    Result result;
+
+    first = qMax(first, 0);
+    last = qMin(last, m_size - 1);
+    if(first > last)
+        return result;
+
+    result.count = last - first + 1;
+    result.sum = m_sums.at(last + 1) - m_sums.at(first);
+    result.won = m_won.at(last + 1) - m_won.at(first);
+    result.lost = result.count - result.won;
+
+    double max = -std::numeric_limits<double>::infinity();
+    double min = std::numeric_limits<double>::infinity();
+
+    for(int l = first + m_size, r = last + m_size + 1; l < r; l /= 2, r /= 2) {
+        if(l & 1) {
+            max = qMax(max, m_maxTree.at(l));
+            min = qMin(min, m_minTree.at(l));
+            l++;
+        }
+        if(r & 1) {
+            r--;
+            max = qMax(max, m_maxTree.at(r));
+            min = qMin(min, m_minTree.at(r));
+        }
+    }
+
+    result.max = max;
+    result.min = min;
+
+    return result;
+}
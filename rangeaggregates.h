@@ -0,0 +1,45 @@
+#ifndef RANGEAGGREGATES_H
+#define RANGEAGGREGATES_H
+
+#include <QVector>
+#include "exactsum.h"
+
+//Answers count/sum/won/lost/max/min queries over contiguous row ranges.
+//Sums and counts come from prefix arrays (O(1) per range), max/min from
+//an iterative segment tree (O(log n) per range).
+class RangeAggregates
+{
+public:
+    struct Result
+    {
+        Result();
+
+        int count;
+        int won;
+        int lost;
+        ExactSum sum;
+        double max;
+        double min;
+
+        void merge(const Result& other);
+    };
+
+    RangeAggregates();
+
+    void build(const QVector<double>& values);
+    void clear();
+
+    int size() const { return m_size; }
+
+    //first and last are inclusive row indices
+    Result query(int first, int last) const;
+
+private:
+    int m_size;
+    QVector<ExactSum> m_sums;
+    QVector<int> m_won;
+    QVector<double> m_maxTree;
+    QVector<double> m_minTree;
+};
+
+#endif // RANGEAGGREGATES_H
@@ -0,0 +1,295 @@
+#include "riskanalytics.h"
+#include <QtGlobal>
+#include <algorithm>
+
+bool RiskAnalytics::Key::operator<(const Key& other) const
+{
+    if(day != other.day)
+        return day < other.day;
+
+    return id < other.id;
+}
+
+RiskAnalytics::Summary::Summary() :
+    count(0),
+    wins(0),
+    maxAmount(0),
+    minAmount(0),
+    winPrefix(0), winSuffix(0), winStreak(0),
+    lossPrefix(0), lossSuffix(0), lossStreak(0)
+{
+}
+
+RiskAnalytics::Summary RiskAnalytics::Summary::leaf(double amount)
+{
+    //Same convention as updateValues: zero counts as a won bet
+    bool won = amount >= 0;
+
+    ExactSum value(amount);
+
+    Summary summary;
+    summary.count = 1;
+    summary.wins = won ? 1 : 0;
+    summary.sum = value;
+    summary.wonSum = won ? value : ExactSum();
+    summary.lostSum = won ? ExactSum() : value;
+    summary.maxAmount = amount;
+    summary.minAmount = amount;
+    summary.maxPrefix = qMax(ExactSum(), value);
+    summary.minPrefix = qMin(ExactSum(), value);
+    summary.maxDrawdown = qMax(ExactSum(), -value);
+    summary.winPrefix = summary.winSuffix = summary.winStreak = won ? 1 : 0;
+    summary.lossPrefix = summary.lossSuffix = summary.lossStreak = won ? 0 : 1;
+
+    return summary;
+}
+
+RiskAnalytics::Summary RiskAnalytics::Summary::combine(const Summary& left, const Summary& right)
+{
+    if(left.count == 0) return right;
+    if(right.count == 0) return left;
+
+    Summary summary;
+    summary.count = left.count + right.count;
+    summary.wins = left.wins + right.wins;
+    summary.sum = left.sum + right.sum;
+    summary.wonSum = left.wonSum + right.wonSum;
+    summary.lostSum = left.lostSum + right.lostSum;
+    summary.maxAmount = qMax(left.maxAmount, right.maxAmount);
+    summary.minAmount = qMin(left.minAmount, right.minAmount);
+
+    //Prefixes are relative to the start of the segment, so the right half is shifted by the left sum.
+    //Exact sums make the result independent of the tree shape the summaries were combined in.
+    summary.maxPrefix = qMax(left.maxPrefix, left.sum + right.maxPrefix);
+    summary.minPrefix = qMin(left.minPrefix, left.sum + right.minPrefix);
+    summary.maxDrawdown = qMax(qMax(left.maxDrawdown, right.maxDrawdown), left.maxPrefix - (left.sum + right.minPrefix));
+
+    summary.winPrefix = left.winPrefix == left.count ? left.count + right.winPrefix : left.winPrefix;
+    summary.winSuffix = right.winSuffix == right.count ? right.count + left.winSuffix : right.winSuffix;
+    summary.winStreak = qMax(qMax(left.winStreak, right.winStreak), left.winSuffix + right.winPrefix);
+
+    summary.lossPrefix = left.lossPrefix == left.count ? left.count + right.lossPrefix : left.lossPrefix;
+    summary.lossSuffix = right.lossSuffix == right.count ? right.count + left.lossSuffix : right.lossSuffix;
+    summary.lossStreak = qMax(qMax(left.lossStreak, right.lossStreak), left.lossSuffix + right.lossPrefix);
+
+    return summary;
+}
+
+RiskAnalytics::RiskAnalytics() :
+    m_root(-1),
+    m_seed(2463534242u)
+{
+}
+
+void RiskAnalytics::clear()
+{
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_root = -1;
+}
+
+void RiskAnalytics::build(QVector<QPair<Key, double> > bets)
+{
+    clear();
+
+    std::sort(bets.begin(), bets.end(), [](const QPair<Key, double>& a, const QPair<Key, double>& b) {
+        return a.first < b.first;
+    });
+
+    m_nodes.reserve(bets.size());
+
+    //Linear Cartesian tree construction: the stack holds the right spine of the tree built so far
+    QVector<int> spine;
+    for(int i = 0; i < bets.size(); i++) {
+        int node = newNode(bets.at(i).first, bets.at(i).second);
+        int last = -1;
+
+        while(!spine.isEmpty() && m_nodes.at(spine.last()).priority < m_nodes.at(node).priority) {
+            last = spine.last();
+            spine.removeLast();
+        }
+
+        m_nodes[node].left = last;
+        if(!spine.isEmpty())
+            m_nodes[spine.last()].right = node;
+
+        spine.append(node);
+    }
+
+    m_root = spine.isEmpty() ? -1 : spine.first();
+    pullTree(m_root);
+}
+
+void RiskAnalytics::insert(const Key& key, double amount)
+{
+    int left, right;
+    split(m_root, key, false, left, right);
+    m_root = merge(merge(left, newNode(key, amount)), right);
+}
+
+bool RiskAnalytics::remove(const Key& key)
+{
+    int left, middle, right;
+    split(m_root, key, false, left, right);
+    split(right, key, true, middle, right);
+
+    bool found = middle != -1;
+    if(found) {
+        //Keys are unique, so the middle part is a single node
+        m_freeNodes.append(middle);
+    }
+
+    m_root = merge(left, right);
+
+    return found;
+}
+
+int RiskAnalytics::count() const
+{
+    return summaryOf(m_root).count;
+}
+
+const RiskAnalytics::Summary& RiskAnalytics::summary() const
+{
+    return summaryOf(m_root);
+}
+
+RiskAnalytics::Summary RiskAnalytics::latest(int count) const
+{
+    return latest(m_root, count);
+}
+
+QVector<int> RiskAnalytics::ids(int firstDay, int lastDay) const
+{
+    QVector<int> result;
+    ids(m_root, firstDay, lastDay, result);
+    return result;
+}
+
+int RiskAnalytics::newNode(const Key& key, double amount)
+{
+    Node node;
+    node.key = key;
+    node.amount = amount;
+    node.priority = nextPriority();
+    node.left = -1;
+    node.right = -1;
+    node.summary = Summary::leaf(amount);
+
+    if(!m_freeNodes.isEmpty()) {
+        int index = m_freeNodes.last();
+        m_freeNodes.removeLast();
+        m_nodes[index] = node;
+        return index;
+    }
+
+    m_nodes.append(node);
+    return m_nodes.size() - 1;
+}
+
+quint32 RiskAnalytics::nextPriority()
+{
+    //xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return m_seed;
+}
+
+const RiskAnalytics::Summary& RiskAnalytics::summaryOf(int node) const
+{
+    return node == -1 ? m_empty : m_nodes.at(node).summary;
+}
+
+void RiskAnalytics::pull(int node)
+{
+    Node& n = m_nodes[node];
+    n.summary = Summary::combine(Summary::combine(summaryOf(n.left), Summary::leaf(n.amount)), summaryOf(n.right));
+}
+
+void RiskAnalytics::pullTree(int node)
+{
+    if(node == -1)
+        return;
+
+    pullTree(m_nodes.at(node).left);
+    pullTree(m_nodes.at(node).right);
+    pull(node);
+}
+
+void RiskAnalytics::split(int node, const Key& key, bool inclusive, int& left, int& right)
+{
+    //left receives keys < key (or <= key when inclusive), right receives the rest
+    if(node == -1) {
+        left = right = -1;
+        return;
+    }
+
+    const Key& nodeKey = m_nodes.at(node).key;
+    bool goesLeft = inclusive ? !(key < nodeKey) : nodeKey < key;
+
+    if(goesLeft) {
+        int rightLeft, rightRight;
+        split(m_nodes.at(node).right, key, inclusive, rightLeft, rightRight);
+        m_nodes[node].right = rightLeft;
+        pull(node);
+        left = node;
+        right = rightRight;
+    }
+    else {
+        int leftLeft, leftRight;
+        split(m_nodes.at(node).left, key, inclusive, leftLeft, leftRight);
+        m_nodes[node].left = leftRight;
+        pull(node);
+        left = leftLeft;
+        right = node;
+    }
+}
+
+int RiskAnalytics::merge(int left, int right)
+{
+    if(left == -1) return right;
+    if(right == -1) return left;
+
+    if(m_nodes.at(left).priority > m_nodes.at(right).priority) {
+        m_nodes[left].right = merge(m_nodes.at(left).right, right);
+        pull(left);
+        return left;
+    }
+
+    m_nodes[right].left = merge(left, m_nodes.at(right).left);
+    pull(right);
+    return right;
+}
+
+RiskAnalytics::Summary RiskAnalytics::latest(int node, int count) const
+{
+    //Summary of the last count bets, assembled from O(log n) subtree summaries
+    if(node == -1 || count <= 0)
+        return m_empty;
+
+    const Node& n = m_nodes.at(node);
+    const Summary& right = summaryOf(n.right);
+
+    if(count <= right.count)
+        return latest(n.right, count);
+
+    Summary tail = Summary::combine(Summary::leaf(n.amount), right);
+    return Summary::combine(latest(n.left, count - right.count - 1), tail);
+}
+
+void RiskAnalytics::ids(int node, int firstDay, int lastDay, QVector<int>& result) const
+{
+    //In-order walk that skips subtrees lying entirely outside the range
+    if(node == -1)
+        return;
+
+    const Node& n = m_nodes.at(node);
+
+    if(n.key.day >= firstDay)
+        ids(n.left, firstDay, lastDay, result);
+    if(n.key.day >= firstDay && n.key.day <= lastDay)
+        result.append(n.key.id);
+    if(n.key.day <= lastDay)
+        ids(n.right, firstDay, lastDay, result);
+}
@@ -0,0 +1,88 @@
+#ifndef RISKANALYTICS_H
+#define RISKANALYTICS_H
+
+#include <QVector>
+#include <QPair>
+#include "exactsum.h"
+
+//Keeps the bet history in chronological order inside a treap whose nodes carry
+//the summary of their subtree (sum, prefix extremes, drawdown, streaks).
+//Inserting or removing a bet re-summarizes only the path to the root, so every
+//metric stays available in expected O(log n) per edit.
+class RiskAnalytics
+{
+public:
+    struct Key
+    {
+        int day;
+        int id;
+
+        bool operator<(const Key& other) const;
+    };
+
+    struct Summary
+    {
+        Summary();
+
+        int count;
+        int wins;
+        ExactSum sum;
+        ExactSum wonSum;
+        ExactSum lostSum;
+        double maxAmount;
+        double minAmount;
+        ExactSum maxPrefix;
+        ExactSum minPrefix;
+        ExactSum maxDrawdown;
+        int winPrefix, winSuffix, winStreak;
+        int lossPrefix, lossSuffix, lossStreak;
+
+        static Summary leaf(double amount);
+        static Summary combine(const Summary& left, const Summary& right);
+    };
+
+    RiskAnalytics();
+
+    void clear();
+    void build(QVector<QPair<Key, double> > bets);
+
+    void insert(const Key& key, double amount);
+    bool remove(const Key& key);
+
+    int count() const;
+    const Summary& summary() const;
+    Summary latest(int count) const;
+
+    //Ids of the bets dated firstDay..lastDay (julian days, inclusive), in chronological order
+    QVector<int> ids(int firstDay, int lastDay) const;
+
+private:
+    struct Node
+    {
+        Key key;
+        double amount;
+        quint32 priority;
+        int left;
+        int right;
+        Summary summary;
+    };
+
+    QVector<Node> m_nodes;
+    QVector<int> m_freeNodes;
+    int m_root;
+    quint32 m_seed;
+    Summary m_empty;
+
+    int newNode(const Key& key, double amount);
+    quint32 nextPriority();
+    const Summary& summaryOf(int node) const;
+    void pull(int node);
+    void pullTree(int node);
+
+    void split(int node, const Key& key, bool inclusive, int& left, int& right);
+    int merge(int left, int right);
+    Summary latest(int node, int count) const;
+    void ids(int node, int firstDay, int lastDay, QVector<int>& result) const;
+};
+
+#endif // RISKANALYTICS_H
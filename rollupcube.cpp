@@ -0,0 +1,120 @@
+#include "rollupcube.h"
+#include <algorithm>
+
+RollupCube::Cell::Cell() :
+    count(0)
+{
+}
+
+void RollupCube::clear()
+{
+    m_cells.clear();
+    m_teams.clear();
+    m_months.clear();
+}
+
+void RollupCube::build(const BetStore& store)
+{
+    clear();
+
+    for(int i = 0; i < store.size(); i++)
+        add(store.days().at(i), store.winners().at(i), store.losers().at(i), store.amount(i));
+}
+
+void RollupCube::add(int day, int winners, int losers, double amount)
+{
+    update(day, winners, losers, amount, 1);
+}
+
+void RollupCube::remove(int day, int winners, int losers, double amount)
+{
+    update(day, winners, losers, amount, -1);
+}
+
+RollupCube::Cell RollupCube::cell(int team, int month, int outcome) const
+{
+    return m_cells.value(key(team, month, outcome));
+}
+
+QList<int> RollupCube::teams() const
+{
+    return m_teams.keys();
+}
+
+QList<int> RollupCube::months() const
+{
+    QList<int> months = m_months.keys();
+    std::sort(months.begin(), months.end());
+    return months;
+}
+
+int RollupCube::month(int julianDay)
+{
+    QDate date = QDate::fromJulianDay(julianDay);
+    return date.year() * 12 + date.month() - 1;
+}
+
+QDate RollupCube::firstDay(int month)
+{
+    //Unparseable dates end up in negative years, so the year is rounded down rather than towards zero
+    int year = month >= 0 ? month / 12 : -((-month + 11) / 12);
+    return QDate(year, month - year * 12 + 1, 1);
+}
+
+quint64 RollupCube::key(int team, int month, int outcome)
+{
+    //Any (-1) is shifted to 0 so team stays non-negative; the month is masked to its 30 bits so
+    //months before year 0 cannot spill into the team field
+    return (quint64(quint32(team + 1)) << 32) | ((quint64(quint32(month + 1)) & 0x3fffffff) << 2) | quint64(outcome);
+}
+
+void RollupCube::update(int day, int winners, int losers, double amount, int sign)
+{
+    //Same convention as the statistics: zero counts as a won bet
+    int outcome = amount >= 0 ? Won : Lost;
+    int month = RollupCube::month(day);
+    ExactSum value(amount);
+
+    update(winners, month, outcome, value, sign);
+    count(m_teams, winners, sign);
+
+    if(losers != winners) {
+        update(losers, month, outcome, value, sign);
+        count(m_teams, losers, sign);
+    }
+
+    update(Any, month, outcome, value, sign);
+    count(m_months, month, sign);
+}
+
+void RollupCube::update(int team, int month, int outcome, const ExactSum& amount, int sign)
+{
+    //The cell itself and its three roll-ups over month and outcome
+    const int months[2] = { month, Any };
+    const int outcomes[2] = { outcome, AnyOutcome };
+
+    for(int m = 0; m < 2; m++) {
+        for(int o = 0; o < 2; o++) {
+            quint64 cellKey = key(team, months[m], outcomes[o]);
+            Cell& cell = m_cells[cellKey];
+
+            cell.count += sign;
+            if(sign > 0)
+                cell.sum += amount;
+            else
+                cell.sum -= amount;
+
+            //Sums are exact, an emptied cell is back to zero and can go
+            if(cell.count == 0)
+                m_cells.remove(cellKey);
+        }
+    }
+}
+
+void RollupCube::count(QHash<int, int>& refs, int value, int sign)
+{
+    int& count = refs[value];
+    count += sign;
+    if(count == 0)
+        refs.remove(value);
+}
@@ -0,0 +1,54 @@
+#ifndef ROLLUPCUBE_H
+#define ROLLUPCUBE_H
+
+#include <QHash>
+#include <QList>
+#include <QDate>
+#include "betstore.h"
+#include "exactsum.h"
+
+//Pre-aggregated cube over (team, month, outcome). Every bet updates one cell in
+//each of the eight group-bys, with Any marking a rolled-up dimension, so any
+//slice or roll-up is a single lookup. A bet counts under both of its teams,
+//but only once when the team dimension is rolled up.
+class RollupCube
+{
+public:
+    enum Outcome { Won, Lost, AnyOutcome };
+    static const int Any = -1;
+
+    struct Cell
+    {
+        Cell();
+
+        int count;
+        ExactSum sum;
+    };
+
+    void clear();
+    void build(const BetStore& store);
+
+    void add(int day, int winners, int losers, double amount);
+    void remove(int day, int winners, int losers, double amount);
+
+    //team and month may be Any, outcome may be AnyOutcome
+    Cell cell(int team, int month, int outcome) const;
+
+    QList<int> teams() const;
+    QList<int> months() const;
+
+    static int month(int julianDay);
+    static QDate firstDay(int month);
+
+private:
+    QHash<quint64, Cell> m_cells;
+    QHash<int, int> m_teams;
+    QHash<int, int> m_months;
+
+    static quint64 key(int team, int month, int outcome);
+    void update(int day, int winners, int losers, double amount, int sign);
+    void update(int team, int month, int outcome, const ExactSum& amount, int sign);
+    static void count(QHash<int, int>& refs, int value, int sign);
+};
+
+#endif // ROLLUPCUBE_H
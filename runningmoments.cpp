@@ -0,0 +1,84 @@
+#include "runningmoments.h"
+#include <qmath.h>
+
+RunningMoments::RunningMoments() :
+    m_count(0),
+    m_mean(0),
+    m_m2(0)
+{
+}
+
+void RunningMoments::clear()
+{
+    m_count = 0;
+    m_mean = 0;
+    m_m2 = 0;
+}
+
+void RunningMoments::add(double value)
+{
+    m_count++;
+
+    double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+}
+
+void RunningMoments::remove(double value)
+{
+    if(m_count <= 1) {
+        clear();
+        return;
+    }
+
+    //Inverse of add: recover the previous mean, then undo its contribution to m2
+    double previousMean = (m_count * m_mean - value) / (m_count - 1);
+    m_m2 -= (value - previousMean) * (value - m_mean);
+    m_mean = previousMean;
+    m_count--;
+
+    if(m_m2 < 0)
+        m_m2 = 0;
+}
+
+void RunningMoments::merge(const RunningMoments& other)
+{
+    if(other.m_count == 0)
+        return;
+
+    if(m_count == 0) {
+        *this = other;
+        return;
+    }
+
+    int count = m_count + other.m_count;
+    double delta = other.m_mean - m_mean;
+
+    m_mean += delta * other.m_count / count;
+    m_m2 += other.m_m2 + delta * delta * m_count * other.m_count / count;
+    m_count = count;
+}
+
+double RunningMoments::variance() const
+{
+    //Sample variance
+    if(m_count < 2)
+        return 0;
+
+    return m_m2 / (m_count - 1);
+}
+
+double RunningMoments::standardDeviation() const
+{
+    return qSqrt(variance());
+}
+
+double RunningMoments::sharpeRatio() const
+{
+    //Mean return per bet over its spread, no risk-free rate
+    double deviation = standardDeviation();
+    if(deviation == 0)
+        return 0;
+
+    return m_mean / deviation;
+}
@@ -0,0 +1,28 @@
+#ifndef RUNNINGMOMENTS_H
+#define RUNNINGMOMENTS_H
+
+//One-pass mean/variance accumulator (Welford). Values can be removed again and
+//partial accumulators merged (Chan et al.), so every edit costs O(1).
+class RunningMoments
+{
+public:
+    RunningMoments();
+
+    void clear();
+    void add(double value);
+    void remove(double value);
+    void merge(const RunningMoments& other);
+
+    int count() const { return m_count; }
+    double mean() const { return m_mean; }
+    double variance() const;
+    double standardDeviation() const;
+    double sharpeRatio() const;
+
+private:
+    int m_count;
+    double m_mean;
+    double m_m2;
+};
+
+#endif // RUNNINGMOMENTS_H
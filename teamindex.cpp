@@ -0,0 +1,157 @@
+#include "teamindex.h"
+#include "teamsymbols.h"
+
+TeamIndex::Team::Team() :
+    id(-1),
+    wins(0),
+    losses(0)
+{
+}
+
+TeamIndex::TeamIndex() :
+    m_sketchesStale(false)
+{
+}
+
+void TeamIndex::clear()
+{
+    m_teams.clear();
+    m_sketchesStale = false;
+}
+
+void TeamIndex::add(int winners, int losers, double amount)
+{
+    Team& winner = entry(winners);
+    winner.wins++;
+    winner.money += ExactSum(amount);
+
+    entry(losers).losses++;
+
+    if(!m_sketchesStale)
+        addToSketches(winners, losers, amount);
+}
+
+void TeamIndex::remove(int winners, int losers, double amount)
+{
+    Team& winner = entry(winners);
+    winner.wins--;
+    winner.money -= ExactSum(amount);
+
+    entry(losers).losses--;
+
+    release(winners);
+    release(losers);
+
+    m_sketchesStale = true;
+}
+
+void TeamIndex::merge(const TeamIndex& other)
+{
+    for(QHash<int, Team>::const_iterator it = other.m_teams.constBegin(); it != other.m_teams.constEnd(); ++it) {
+        Team& team = entry(it.key());
+        team.wins += it->wins;
+        team.losses += it->losses;
+        team.money += it->money;
+        team.amounts.merge(it->amounts);
+    }
+
+    m_sketchesStale = m_sketchesStale || other.m_sketchesStale;
+}
+
+void TeamIndex::clearSketches()
+{
+    for(QHash<int, Team>::iterator it = m_teams.begin(); it != m_teams.end(); ++it)
+        it->amounts.clear();
+
+    m_sketchesStale = false;
+}
+
+void TeamIndex::addToSketches(int winners, int losers, double amount)
+{
+    entry(winners).amounts.add(amount);
+    if(losers != winners)
+        entry(losers).amounts.add(amount);
+}
+
+const TeamIndex::Team* TeamIndex::team(int id) const
+{
+    QHash<int, Team>::const_iterator it = m_teams.constFind(id);
+    return it == m_teams.constEnd() ? nullptr : &it.value();
+}
+
+const TeamIndex::Team* TeamIndex::team(const QString& name) const
+{
+    TeamSymbols& symbols = TeamSymbols::instance();
+    return team(symbols.canonical(symbols.find(name)));
+}
+
+QStringList TeamIndex::names() const
+{
+    QStringList names;
+    for(QHash<int, Team>::const_iterator it = m_teams.constBegin(); it != m_teams.constEnd(); ++it)
+        names.append(TeamSymbols::instance().name(it.key()));
+
+    names.sort(Qt::CaseInsensitive);
+    return names;
+}
+
+namespace {
+
+//Ties go to the alphabetically first team so the result does not depend on hash order
+bool before(const TeamIndex::Team& a, const TeamIndex::Team& b)
+{
+    return TeamSymbols::instance().name(a.id).compare(TeamSymbols::instance().name(b.id), Qt::CaseInsensitive) < 0;
+}
+
+}
+
+const TeamIndex::Team* TeamIndex::mostWins() const
+{
+    const Team* best = nullptr;
+    for(QHash<int, Team>::const_iterator it = m_teams.constBegin(); it != m_teams.constEnd(); ++it) {
+        if(best == nullptr || it->wins > best->wins || (it->wins == best->wins && before(*it, *best)))
+            best = &it.value();
+    }
+
+    return best;
+}
+
+const TeamIndex::Team* TeamIndex::mostMoney() const
+{
+    const Team* best = nullptr;
+    for(QHash<int, Team>::const_iterator it = m_teams.constBegin(); it != m_teams.constEnd(); ++it) {
+        if(it->wins == 0)
+            continue;
+
+        if(best == nullptr || it->money > best->money || (it->money == best->money && before(*it, *best)))
+            best = &it.value();
+    }
+
+    return best;
+}
+
+const TeamIndex::Team* TeamIndex::mostLosses() const
+{
+    const Team* worst = nullptr;
+    for(QHash<int, Team>::const_iterator it = m_teams.constBegin(); it != m_teams.constEnd(); ++it) {
+        if(worst == nullptr || it->losses > worst->losses || (it->losses == worst->losses && before(*it, *worst)))
+            worst = &it.value();
+    }
+
+    return worst;
+}
+
+TeamIndex::Team& TeamIndex::entry(int id)
+{
+    Team& team = m_teams[id];
+    team.id = id;
+
+    return team;
+}
+
+void TeamIndex::release(int id)
+{
+    QHash<int, Team>::iterator it = m_teams.find(id);
+    if(it != m_teams.end() && it->wins <= 0 && it->losses <= 0)
+        m_teams.erase(it);
+}
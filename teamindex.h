@@ -0,0 +1,55 @@
+#ifndef TEAMINDEX_H
+#define TEAMINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include "quantilesketch.h"
+#include "exactsum.h"
+
+//Per-team aggregates keyed by interned team id (see TeamSymbols), kept up to date
+//on every add/remove so the best/worst teams no longer need a pass over the table.
+class TeamIndex
+{
+public:
+    struct Team
+    {
+        Team();
+
+        int id;
+        int wins;
+        int losses;
+        ExactSum money;
+        QuantileSketch amounts;
+    };
+
+    TeamIndex();
+
+    void clear();
+    void add(int winners, int losers, double amount);
+    void remove(int winners, int losers, double amount);
+    void merge(const TeamIndex& other);
+
+    //Sketches cannot forget values, so removals leave them stale until rebuilt
+    bool sketchesStale() const { return m_sketchesStale; }
+    void clearSketches();
+    void addToSketches(int winners, int losers, double amount);
+
+    const Team* team(int id) const;
+    const Team* team(const QString& name) const;
+    QStringList names() const;
+    QList<int> ids() const { return m_teams.keys(); }
+
+    const Team* mostWins() const;
+    const Team* mostMoney() const;
+    const Team* mostLosses() const;
+
+private:
+    QHash<int, Team> m_teams;
+    bool m_sketchesStale;
+
+    Team& entry(int id);
+    void release(int id);
+};
+
+#endif // TEAMINDEX_H
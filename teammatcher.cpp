@@ -0,0 +1,155 @@
+#include "teammatcher.h"
+#include <QHash>
+#include <QtMath>
+#include <algorithm>
+
+//Acronyms share almost no trigrams with the full name, they get a fixed score
+static const double AcronymScore = 0.7;
+
+TeamMatcher::TeamMatcher(double threshold) :
+    m_threshold(threshold)
+{
+}
+
+QVector<TeamMatcher::Match> TeamMatcher::matches(const QVector<QString>& names) const
+{
+    const int count = names.size();
+
+    //Distinct trigram ids of every name, padded so word boundaries count
+    QHash<quint64, int> gramIds;
+    QVector<QVector<int> > grams(count);
+    QVector<int> frequency;
+
+    for(int i = 0; i < count; i++) {
+        QString padded = " " + names.at(i) + " ";
+        QVector<int>& set = grams[i];
+
+        for(int j = 0; j + 3 <= padded.size(); j++) {
+            quint64 key = (quint64(padded.at(j).unicode()) << 32) | (quint64(padded.at(j + 1).unicode()) << 16) | padded.at(j + 2).unicode();
+
+            int id = gramIds.value(key, -1);
+            if(id == -1) {
+                id = frequency.size();
+                gramIds.insert(key, id);
+                frequency.append(0);
+            }
+            set.append(id);
+        }
+
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+
+        for(int j = 0; j < set.size(); j++)
+            frequency[set.at(j)]++;
+    }
+
+    //Renumber the trigrams by rarity so the first entries of a sorted set are its rarest
+    QVector<int> order(frequency.size());
+    for(int i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&frequency](int a, int b) {
+        return frequency.at(a) != frequency.at(b) ? frequency.at(a) < frequency.at(b) : a < b;
+    });
+
+    QVector<int> rank(order.size());
+    for(int i = 0; i < order.size(); i++)
+        rank[order.at(i)] = i;
+
+    for(int i = 0; i < count; i++) {
+        QVector<int>& set = grams[i];
+        for(int j = 0; j < set.size(); j++)
+            set[j] = rank.at(set.at(j));
+        std::sort(set.begin(), set.end());
+    }
+
+    QVector<Match> result;
+    QVector<QVector<int> > postings(frequency.size());
+    QVector<int> seen(count, -1);
+    QVector<int> candidates;
+
+    for(int i = 0; i < count; i++) {
+        const QVector<int>& set = grams.at(i);
+        int size = set.size();
+        if(size == 0)
+            continue;
+
+        //Dice >= t needs an overlap of at least t * size / (2 - t), so two similar
+        //names always share one of their first size - overlap + 1 trigrams
+        int overlap = qCeil(m_threshold * size / (2 - m_threshold));
+        int prefix = qMax(size - overlap + 1, 1);
+
+        candidates.clear();
+        for(int k = 0; k < prefix; k++) {
+            const QVector<int>& posting = postings.at(set.at(k));
+            for(int p = 0; p < posting.size(); p++) {
+                if(seen.at(posting.at(p)) != i) {
+                    seen[posting.at(p)] = i;
+                    candidates.append(posting.at(p));
+                }
+            }
+        }
+
+        for(int c = 0; c < candidates.size(); c++) {
+            const QVector<int>& other = grams.at(candidates.at(c));
+            int otherSize = other.size();
+
+            if(2.0 * qMin(size, otherSize) / (size + otherSize) < m_threshold)
+                continue;
+
+            int shared = 0;
+            for(int a = 0, b = 0; a < size && b < otherSize;) {
+                if(set.at(a) < other.at(b)) a++;
+                else if(other.at(b) < set.at(a)) b++;
+                else { shared++; a++; b++; }
+            }
+
+            double score = 2.0 * shared / (size + otherSize);
+            if(score >= m_threshold) {
+                Match match = { candidates.at(c), i, score };
+                result.append(match);
+            }
+        }
+
+        for(int k = 0; k < prefix; k++)
+            postings[set.at(k)].append(i);
+    }
+
+    //Acronyms: single words matching the initials of a name with several words
+    QHash<QString, QVector<int> > byInitials;
+    for(int i = 0; i < count; i++) {
+        QString key = initials(names.at(i));
+        if(!key.isEmpty())
+            byInitials[key].append(i);
+    }
+
+    for(int i = 0; i < count; i++) {
+        const QString& name = names.at(i);
+        if(name.size() < 3 || name.size() > 6 || name.contains(' '))
+            continue;
+
+        QVector<int> full = byInitials.value(name);
+        for(int j = 0; j < full.size(); j++) {
+            Match match = { full.at(j), i, AcronymScore };
+            result.append(match);
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const Match& a, const Match& b) {
+        return a.score > b.score;
+    });
+
+    return result;
+}
+
+QString TeamMatcher::initials(const QString& name)
+{
+    QStringList words = name.split(' ', QString::SkipEmptyParts);
+    if(words.size() < 2)
+        return QString();
+
+    QString result;
+    for(int i = 0; i < words.size(); i++)
+        result.append(words.at(i).at(0));
+
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef TEAMMATCHER_H
+#define TEAMMATCHER_H
+
+#include <QVector>
+#include <QString>
+
+//Finds spellings that probably name the same team. Names are compared by the
+//Dice coefficient of their padded character trigrams; an inverted index over
+//the rarest trigrams of every name (prefix filtering) limits the comparisons
+//to pairs that can still reach the threshold. Short names that equal the
+//initials of a longer one ("nip" / "ninja in pyjamas") are proposed as well.
+class TeamMatcher
+{
+public:
+    struct Match
+    {
+        int first;
+        int second;
+        double score;
+    };
+
+    explicit TeamMatcher(double threshold = 0.75);
+
+    //Names are expected normalized (see TeamSymbols::fold). Matches refer to
+    //indices into names and come sorted by descending score.
+    QVector<Match> matches(const QVector<QString>& names) const;
+
+private:
+    double m_threshold;
+
+    static QString initials(const QString& name);
+};
+
+#endif // TEAMMATCHER_H
@@ -0,0 +1,95 @@
+#include "teamsymbols.h"
+
+TeamSymbols& TeamSymbols::instance()
+{
+    static TeamSymbols symbols;
+    return symbols;
+}
+
+int TeamSymbols::intern(const QString& name)
+{
+    QString key = fold(name);
+
+    {
+        QReadLocker locker(&m_lock);
+        QHash<QString, int>::const_iterator it = m_ids.constFind(key);
+        if(it != m_ids.constEnd())
+            return it.value();
+    }
+
+    QWriteLocker locker(&m_lock);
+
+    //Another thread may have interned the name between the two locks
+    QHash<QString, int>::const_iterator it = m_ids.constFind(key);
+    if(it != m_ids.constEnd())
+        return it.value();
+
+    int id = m_names.size();
+    m_ids.insert(key, id);
+    m_names.append(name.simplified());
+    m_canonical.append(id);
+    m_revision++;
+
+    return id;
+}
+
+int TeamSymbols::find(const QString& name) const
+{
+    QReadLocker locker(&m_lock);
+    return m_ids.value(fold(name), -1);
+}
+
+QString TeamSymbols::name(int id) const
+{
+    QReadLocker locker(&m_lock);
+    return id >= 0 && id < m_names.size() ? m_names.at(id) : QString();
+}
+
+int TeamSymbols::count() const
+{
+    QReadLocker locker(&m_lock);
+    return m_names.size();
+}
+
+int TeamSymbols::revision() const
+{
+    QReadLocker locker(&m_lock);
+    return m_revision;
+}
+
+int TeamSymbols::canonical(int id) const
+{
+    QReadLocker locker(&m_lock);
+    if(id < 0 || id >= m_canonical.size())
+        return id;
+
+    //setAlias keeps chains flat, one lookup is enough
+    return m_canonical.at(id);
+}
+
+void TeamSymbols::setAlias(int alias, int canonical)
+{
+    QWriteLocker locker(&m_lock);
+    if(alias < 0 || alias >= m_canonical.size() || canonical < 0 || canonical >= m_canonical.size())
+        return;
+
+    canonical = m_canonical.at(canonical);
+    if(canonical == alias)
+        return;
+
+    //Everything that resolved to the alias follows it to the new canonical id
+    int previous = m_canonical.at(alias);
+    for(int i = 0; i < m_canonical.size(); i++) {
+        if(m_canonical.at(i) == previous)
+            m_canonical[i] = canonical;
+    }
+    m_revision++;
+}
+
+void TeamSymbols::clearAliases()
+{
+    QWriteLocker locker(&m_lock);
+    for(int i = 0; i < m_canonical.size(); i++)
+        m_canonical[i] = i;
+    m_revision++;
+}
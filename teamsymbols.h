@@ -0,0 +1,45 @@
+#ifndef TEAMSYMBOLS_H
+#define TEAMSYMBOLS_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QReadWriteLock>
+
+//Process-wide team name table. Each case-folded name is mapped to a small
+//integer id once, when a bet is loaded or entered; grouping and comparing teams
+//afterwards only touches integers. The first spelling seen is the display name.
+//Names are normalized before lookup (case folding, collapsed whitespace), and
+//confirmed aliases map a spelling onto the id of another team.
+class TeamSymbols
+{
+public:
+    static TeamSymbols& instance();
+
+    static QString fold(const QString& name) { return name.simplified().toCaseFolded(); }
+
+    int intern(const QString& name);
+    int find(const QString& name) const;
+    QString name(int id) const;
+    int count() const;
+
+    //Changes whenever a name is added or an alias changes, so ids resolved from names can be refreshed
+    int revision() const;
+
+    //Aggregates group bets by canonical id, an id without alias is its own canonical id
+    int canonical(int id) const;
+    void setAlias(int alias, int canonical);
+    void clearAliases();
+
+private:
+    TeamSymbols() : m_revision(0) {}
+    Q_DISABLE_COPY(TeamSymbols)
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, int> m_ids;
+    QVector<QString> m_names;
+    QVector<int> m_canonical;
+    int m_revision;
+};
+
+#endif // TEAMSYMBOLS_H